@@ -3,9 +3,28 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <assert.h>
 #include <time.h>
+#include <errno.h>
+#include <chrono>
 #include <regex>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <queue>
+#include <thread>
+#include <atomic>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+#endif
 #define MAX_VARS 16  // the largest allowed number of inputs
 #define MAX_SIZE 256 // the number of initially allocated objects
 
@@ -32,6 +51,101 @@ static inline int  kc_truth_word_num( int n )  { return n <= 6 ? 1 : 1 << (n-6);
 // swapping two variables
 #define KC_SWAP(Type, a, b)  { Type t = a; a = b; b = t; }
 
+// checks whether the file name ends with the given extension
+static inline int kc_file_has_ext(char *pFileName, const char *pExt)
+{
+    int nName = strlen(pFileName), nExt = strlen(pExt);
+    return nName >= nExt && !strcmp(pFileName + nName - nExt, pExt);
+}
+// the wall-clock time in seconds
+static inline double kc_wall_time()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*************************************************************
+                   Profiling counters
+**************************************************************/
+
+// the counters are compiled in with -DKC_PROFILE and the timers with -DKC_PROFILE=2
+enum
+{
+    KC_PROF_HASH_NODE,   // calls to structural and functional hashing of new nodes
+    KC_PROF_STRASH_HIT,  // nodes found by structural hashing
+    KC_PROF_FHASH_HIT,   // nodes found by functional hashing
+    KC_PROF_HASH_FUNC,   // calls to functional hashing of cofactors
+    KC_PROF_HASH_HIT,    // cofactors found by functional hashing
+    KC_PROF_PROBES,      // objects compared during hashing
+    KC_PROF_COF,         // cofactors computed
+    KC_PROF_SWAP,        // swaps of variables in truth tables
+    KC_PROF_GROW,        // reallocations of truth tables
+    KC_PROF_COUNT2,      // node-count traversals to compare expansions
+    KC_PROF_REC_AND,     // calls to AND recursion
+    KC_PROF_REC_XOR,     // calls to XOR recursion
+    KC_PROF_SYNTH,       // synthesis runs for one variable order
+    KC_PROF_LIB,         // functions of the bottom variables built from the library
+    KC_PROF_NUM
+};
+static const char *s_ProfNames[KC_PROF_NUM] = {
+    "hash_node", "strash_hit", "fhash_hit", "hash_function", "hash_function_hit", "hash_probes",
+    "cofactors", "swap_vars", "vt_grow", "node_count2", "rec_and", "rec_xor", "synthesis", "library"};
+
+#ifdef KC_PROFILE
+// (the counters are shared by the threads of the verification and the portfolio; the times are in nanoseconds)
+static std::atomic<long long> s_ProfCounts[KC_PROF_NUM];
+static std::atomic<long long> s_ProfTimes[KC_PROF_NUM];
+#define KC_PROF_COUNT(id) (s_ProfCounts[id].fetch_add(1, std::memory_order_relaxed))
+#if KC_PROFILE > 1
+// adds the time between construction and destruction to the timer
+struct kc_prof_timer
+{
+    int id;
+    std::chrono::steady_clock::time_point start;
+    kc_prof_timer(int i) : id(i), start(std::chrono::steady_clock::now()) {}
+    ~kc_prof_timer() { s_ProfTimes[id].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed); }
+};
+#define KC_PROF_TIME(id) kc_prof_timer kc_prof_timer_(id)
+#else
+#define KC_PROF_TIME(id)
+#endif
+#else
+#define KC_PROF_COUNT(id) ((void)0)
+#define KC_PROF_TIME(id)
+#endif
+
+// prints the counters as a table or as JSON
+static inline void kc_prof_print(int fJson)
+{
+#ifdef KC_PROFILE
+    int i, fTimes = KC_PROFILE > 1;
+    if (fJson)
+    {
+        printf("{");
+        for (i = 0; i < KC_PROF_NUM; i++)
+        {
+            printf("%s\n  \"%s\": {\"count\": %lld", i ? "," : "", s_ProfNames[i], s_ProfCounts[i].load());
+            if (fTimes)
+                printf(", \"time\": %.6f", 1e-9 * s_ProfTimes[i]);
+            printf("}");
+        }
+        printf("\n}\n");
+        return;
+    }
+    printf("Profile:%25s%s\n", "count", fTimes ? "        time" : "");
+    for (i = 0; i < KC_PROF_NUM; i++)
+    {
+        printf("  %-18s %12lld", s_ProfNames[i], s_ProfCounts[i].load());
+        if (fTimes && s_ProfTimes[i] > 0)
+            printf("  %6.2f sec", 1e-9 * s_ProfTimes[i]);
+        printf("\n");
+    }
+#else
+    (void)fJson;
+    (void)s_ProfNames;
+    printf("Profiling is not compiled in (rebuild with -DKC_PROFILE or -DKC_PROFILE=2).\n");
+#endif
+}
+
 /*************************************************************
                  Vector of 32-bit integers
 **************************************************************/
@@ -138,8 +252,20 @@ typedef struct kc_vt_
     int cap;
     int words;
     kc_uint64 *ptr;
+    size_t mapped; // the size of the memory-mapped file holding the truth tables (0 if ptr is allocated)
 } kc_vt;
 
+#define KC_TTB_HEADER 64 // the size of the header of the binary truth-table file in bytes
+
+// releases the memory-mapped truth tables (ptr points right after the file header)
+static inline void kc_vt_unmap(kc_vt *v)
+{
+#ifndef _WIN32
+    munmap((char *)v->ptr - KC_TTB_HEADER, v->mapped);
+#endif
+    v->mapped = 0;
+}
+
 static inline kc_uint64 *kc_vt_array(kc_vt *v) { return v->ptr; }
 static inline int kc_vt_words(kc_vt *v) { return v->words; }
 static inline int kc_vt_size(kc_vt *v) { return v->size; }
@@ -160,10 +286,18 @@ static inline kc_uint64 *kc_vt_read(kc_vt *v, int ttId)
 }
 static inline void kc_vt_grow(kc_vt *v)
 {
+    if (v->size == v->cap && v->mapped)
+    { // move memory-mapped tables to the heap before growing
+        kc_uint64 *ptr = (kc_uint64 *)malloc(8 * v->cap * v->words);
+        memcpy(ptr, v->ptr, 8 * v->size * v->words);
+        kc_vt_unmap(v);
+        v->ptr = ptr;
+    }
     if (v->size == v->cap)
     {
+        KC_PROF_COUNT(KC_PROF_GROW);
         int newcap = (v->cap < 4) ? 8 : (v->cap / 2) * 3;
-        v->ptr = (kc_uint64 *)realloc(v->ptr, 8 * newcap * v->words);
+        v->ptr = (kc_uint64 *)realloc(v->ptr, 8 * (size_t)newcap * v->words);
         if (v->ptr == NULL)
         {
             printf("Failed to realloc memory from %.1f MB to %.1f MB.\n", 4.0 * v->cap * v->words / (1 << 20), 4.0 * newcap * v->words / (1 << 20));
@@ -180,7 +314,8 @@ static inline kc_uint64 *kc_vt_append(kc_vt *v)
 static inline void kc_vt_move(kc_vt *v, kc_vt *v2, int ttId)
 {
     assert(v->words == v2->words);
-    memmove(kc_vt_append(v), kc_vt_read(v2, ttId), 8 * v->words);
+    kc_uint64 *pNew = kc_vt_append(v); // append first because the table may be in the same vector
+    memmove(pNew, kc_vt_read(v2, ttId), 8 * v->words);
 }
 
 /*************************************************************
@@ -202,20 +337,52 @@ static kc_uint64 s_Truths6Neg[6] = {
     0x0000FFFF0000FFFF,
     0x00000000FFFFFFFF};
 
+// repeats the truth table of fewer than 6 variables to fill the word
+static inline kc_uint64 kc_truth_stretch(kc_uint64 t, int nVars)
+{
+    assert(nVars >= 0);
+    if (nVars == 0)
+        nVars++, t = (t & 0x1) | ((t & 0x1) << 1);
+    if (nVars == 1)
+        nVars++, t = (t & 0x3) | ((t & 0x3) << 2);
+    if (nVars == 2)
+        nVars++, t = (t & 0xF) | ((t & 0xF) << 4);
+    if (nVars == 3)
+        nVars++, t = (t & 0xFF) | ((t & 0xFF) << 8);
+    if (nVars == 4)
+        nVars++, t = (t & 0xFFFF) | ((t & 0xFFFF) << 16);
+    if (nVars == 5)
+        nVars++, t = (t & 0xFFFFFFFF) | ((t & 0xFFFFFFFF) << 32);
+    assert(nVars == 6);
+    return t;
+}
 static inline void kc_vt_start(kc_vt *v, int cap, int words)
 {
     v->size = 0;
     v->cap = cap;
     v->words = words;
     v->ptr = (kc_uint64 *)malloc(8 * v->cap * v->words);
+    v->mapped = 0;
 }
-static inline void kc_vt_start_truth(kc_vt *v, int nvars)
+// restarts the vector for the given number of words while keeping the allocated memory
+static inline void kc_vt_restart(kc_vt *v, int cap, int words)
+{
+    assert(!v->mapped);
+    v->cap = (int)((long long)v->cap * v->words / words);
+    v->words = words;
+    v->size = 0;
+    if (v->cap < cap)
+    {
+        v->cap = cap;
+        v->ptr = (kc_uint64 *)realloc(v->ptr, 8 * v->cap * v->words);
+    }
+}
+// fills in the truth tables of the constants and elementary variables (the memory is already allocated)
+static inline void kc_vt_fill_truth(kc_vt *v, int nvars)
 {
     int i, k;
-    v->words = kc_truth_word_num(nvars);
+    assert(v->words == kc_truth_word_num(nvars) && v->cap >= 2 * (nvars + 1));
     v->size = 2 * (nvars + 1);
-    v->cap = 6 * (nvars + 1);
-    v->ptr = (kc_uint64 *)malloc(8 * v->words * v->cap);
     memset(v->ptr, 0, 8 * v->words);
     memset(v->ptr + v->words, 0xFF, 8 * v->words);
     for (i = 0; i < 2 * nvars; i++)
@@ -233,7 +400,18 @@ static inline void kc_vt_start_truth(kc_vt *v, int nvars)
         // printf( "lit = %2d  ", i+2 ); kc_vt_print(v, i+2);
     }
 }
-static inline void kc_vt_stop(kc_vt *v) { free(v->ptr); }
+static inline void kc_vt_start_truth(kc_vt *v, int nvars)
+{
+    kc_vt_start(v, 6 * (nvars + 1), kc_truth_word_num(nvars));
+    kc_vt_fill_truth(v, nvars);
+}
+static inline void kc_vt_stop(kc_vt *v)
+{
+    if (v->mapped)
+        kc_vt_unmap(v);
+    else
+        free(v->ptr);
+}
 static inline void kc_vt_dup(kc_vt *vNew, kc_vt *v)
 {
     kc_vt_start(vNew, v->cap, v->words);
@@ -265,6 +443,17 @@ static inline int kc_vt_xor(kc_vt *v, int ttA, int ttB)
         pF[i] = pA[i] ^ pB[i];
     return v->size - 1;
 }
+// the same for the first words of the truth tables
+static inline int kc_vt_xor_words(kc_vt *v, int ttA, int ttB, int nWords)
+{
+    kc_uint64 *pF = kc_vt_append(v);
+    int i;
+    kc_uint64 *pA = kc_vt_read(v, ttA);
+    kc_uint64 *pB = kc_vt_read(v, ttB);
+    for (i = 0; i < nWords; i++)
+        pF[i] = pA[i] ^ pB[i];
+    return v->size - 1;
+}
 static inline int kc_vt_inv(kc_vt *v, int ttA)
 {
     kc_uint64 *pF = kc_vt_append(v);
@@ -295,6 +484,52 @@ static inline int kc_vt_is_equal2(kc_vt *vA, int ttA, kc_vt *vB, int ttB)
             return 0;
     return 1;
 }
+static inline int kc_vt_is_equal2_words(kc_vt *vA, int ttA, kc_vt *vB, int ttB, int nWords)
+{
+    kc_uint64 *pA = kc_vt_read(vA, ttA);
+    kc_uint64 *pB = kc_vt_read(vB, ttB);
+    int i;
+    for (i = 0; i < nWords; i++)
+        if (pA[i] != pB[i])
+            return 0;
+    return 1;
+}
+// the number of the first words of the truth table that are repeated in the rest of it
+// (the function does not depend on the variables above the ones spanned by these words)
+static inline int kc_vt_width(kc_vt *v, int ttId)
+{
+    kc_uint64 *pA = kc_vt_read(v, ttId);
+    int w = v->words;
+    while (w > 1 && !memcmp(pA, pA + w / 2, 4 * w))
+        w /= 2;
+    return w;
+}
+static inline kc_uint64 kc_vt_hash(kc_vt *v, int ttId)
+{
+    kc_uint64 *pA = kc_vt_read(v, ttId), Key = 0;
+    int i;
+    for (i = 0; i < v->words; i++)
+    {
+        Key = (Key + pA[i]) * 0x9E3779B97F4A7C15;
+        Key ^= Key >> 29;
+    }
+    return Key;
+}
+static inline int kc_word_count_ones(kc_uint64 x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555);
+    x = (x & 0x3333333333333333) + ((x >> 2) & 0x3333333333333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0F;
+    return (int)((x * 0x0101010101010101) >> 56);
+}
+static inline int kc_vt_count_ones(kc_vt *v, int ttA)
+{
+    kc_uint64 *pA = kc_vt_read(v, ttA);
+    int i, Res = 0;
+    for (i = 0; i < v->words; i++)
+        Res += kc_word_count_ones(pA[i]);
+    return Res;
+}
 static inline int kc_vt_is_const0(kc_vt *v, int ttA)
 {
     kc_uint64 *pA = kc_vt_read(v, ttA);
@@ -337,6 +572,8 @@ static inline int kc_vt_has_var(kc_vt *v, int ttId, int iVar)
 }
 static inline int kc_vt_cof0(kc_vt *v, int ttId, int iVar)
 {
+    KC_PROF_COUNT(KC_PROF_COF);
+    KC_PROF_TIME(KC_PROF_COF);
     kc_uint64 *ttNew = kc_vt_append(v);
     kc_uint64 *tt = kc_vt_read(v, ttId);
     assert(iVar >= 0);
@@ -361,6 +598,8 @@ static inline int kc_vt_cof0(kc_vt *v, int ttId, int iVar)
 }
 static inline int kc_vt_cof1(kc_vt *v, int ttId, int iVar)
 {
+    KC_PROF_COUNT(KC_PROF_COF);
+    KC_PROF_TIME(KC_PROF_COF);
     kc_uint64 *ttNew = kc_vt_append(v);
     kc_uint64 *tt = kc_vt_read(v, ttId);
     assert(iVar >= 0);
@@ -384,6 +623,41 @@ static inline int kc_vt_cof1(kc_vt *v, int ttId, int iVar)
     return v->size - 1;
 }
 
+// the same for the function that does not depend on the variables above iVar; the function is given by the first
+// kc_truth_word_num(iVar+1) words of the truth table, and the cofactors by the first kc_truth_word_num(iVar) words
+// (the width of the truth tables halves at each step of the recursion, and the other words are not used)
+static inline int kc_vt_has_var_top(kc_vt *v, int ttId, int iVar)
+{
+    kc_uint64 *tt = kc_vt_read(v, ttId);
+    if (iVar < 6)
+        return ((tt[0] >> (1 << iVar)) & s_Truths6Neg[iVar]) != (tt[0] & s_Truths6Neg[iVar]);
+    return memcmp(tt, tt + kc_truth_word_num(iVar), 8 * kc_truth_word_num(iVar)) != 0;
+}
+static inline int kc_vt_cof0_top(kc_vt *v, int ttId, int iVar)
+{
+    KC_PROF_COUNT(KC_PROF_COF);
+    KC_PROF_TIME(KC_PROF_COF);
+    kc_uint64 *ttNew = kc_vt_append(v);
+    kc_uint64 *tt = kc_vt_read(v, ttId);
+    if (iVar <= 5)
+        ttNew[0] = ((tt[0] & s_Truths6Neg[iVar]) << (1 << iVar)) | (tt[0] & s_Truths6Neg[iVar]);
+    else
+        memcpy(ttNew, tt, 8 * kc_truth_word_num(iVar));
+    return v->size - 1;
+}
+static inline int kc_vt_cof1_top(kc_vt *v, int ttId, int iVar)
+{
+    KC_PROF_COUNT(KC_PROF_COF);
+    KC_PROF_TIME(KC_PROF_COF);
+    kc_uint64 *ttNew = kc_vt_append(v);
+    kc_uint64 *tt = kc_vt_read(v, ttId);
+    if (iVar <= 5)
+        ttNew[0] = (tt[0] & s_Truths6[iVar]) | ((tt[0] & s_Truths6[iVar]) >> (1 << iVar));
+    else
+        memcpy(ttNew, tt + kc_truth_word_num(iVar), 8 * kc_truth_word_num(iVar));
+    return v->size - 1;
+}
+
 /*************************************************************
              Swapping variables in truth tables
 **************************************************************/
@@ -434,6 +708,8 @@ static inline void kc_vt_swap_vars(kc_vt *v, int ttId, int iVar, int jVar)
 {
     if (iVar == jVar)
         return;
+    KC_PROF_COUNT(KC_PROF_SWAP);
+    KC_PROF_TIME(KC_PROF_SWAP);
     if (jVar < iVar)
         KC_SWAP(int, iVar, jVar)
     assert(kc_truth_word_num(iVar + 1) <= v->words);
@@ -473,6 +749,116 @@ static inline void kc_vt_swap_vars(kc_vt *v, int ttId, int iVar, int jVar)
     }
 }
 
+// permutes the variables of all truth tables so that position k receives the variable at position pFrom[k];
+// unlike a sequence of swaps, each making a pass over all tables, the permutation is decomposed into at most
+// three groups of stages applied to one table at a time while it stays in the cache: the exchanges of the variables
+// moving into and out of the words, the gathering of the words into their new places (which permutes all variables
+// outside of the words at once), and at most five mask-and-shift stages permuting the variables inside the words
+static void kc_vt_permute(kc_vt *v, int *pFrom, int nVars)
+{
+    int Cur[MAX_VARS], Dest[MAX_VARS], HiFrom[MAX_VARS], Lo[6], Hi[6], Arr[6];
+    kc_uint64 Masks[6][3];
+    int k, p, r, t, w, nLow = kc_min(nVars, 6), nPairs = 0, nSwaps = 0, fMoveWords = 0, Shifts[6];
+    assert(kc_truth_word_num(nVars) <= v->words);
+    for (k = 0; k < nVars; k++)
+        Cur[k] = k, Dest[pFrom[k]] = k;
+    // pair the variables leaving the words with the variables entering them (the entering variable
+    // is exchanged directly into its final position if the variable there is leaving)
+    int Used[MAX_VARS] = {0};
+    for (k = 0; k < nLow; k++)
+        if (Dest[k] >= 6 && pFrom[k] >= 6)
+            Lo[nPairs] = k, Hi[nPairs++] = pFrom[k], Used[k] = Used[pFrom[k]] = 1;
+    for (k = 0, p = 6; k < nLow; k++)
+        if (Dest[k] >= 6 && !Used[k])
+        {
+            while (Dest[p] >= 6 || Used[p])
+                p++;
+            Lo[nPairs] = k, Hi[nPairs++] = p++;
+        }
+    for (r = 0; r < nPairs; r++)
+        KC_SWAP(int, Cur[Lo[r]], Cur[Hi[r]])
+    // decompose the permutation inside the words into swaps
+    for (k = 0; k < nLow; k++)
+        Arr[k] = k;
+    for (k = 0; k < nLow; k++)
+    {
+        for (p = k; Cur[Arr[p]] != pFrom[k]; p++)
+            ;
+        if (p == k)
+            continue;
+        memcpy(Masks[nSwaps], s_PPMasks[k][p], sizeof(Masks[0]));
+        Shifts[nSwaps++] = (1 << p) - (1 << k);
+        KC_SWAP(int, Arr[k], Arr[p])
+    }
+    // find the source of each word (the word index bits of the positions outside of the words are permuted)
+    for (k = 6; k < nVars; k++)
+    {
+        for (p = 6; Cur[p] != pFrom[k]; p++)
+            ;
+        HiFrom[k] = p;
+        fMoveWords |= p != k;
+    }
+    if (nPairs == 0 && nSwaps == 0 && !fMoveWords)
+        return;
+    KC_PROF_COUNT(KC_PROF_SWAP);
+    KC_PROF_TIME(KC_PROF_SWAP);
+    int Map[1 << (MAX_VARS - 6)];
+    kc_uint64 Temp[1 << (MAX_VARS - 6)];
+    assert(v->words <= (1 << (MAX_VARS - 6)));
+    for (k = 0, Map[0] = 0; (1 << k) < v->words; k++) // the words with the index bit k set follow the others
+        for (w = 0; w < (1 << k); w++)
+            Map[w + (1 << k)] = Map[w] | (6 + k < nVars ? 1 << (HiFrom[6 + k] - 6) : 1 << k);
+    for (t = 0; t < v->size; t++)
+    {
+        kc_uint64 *tt = kc_vt_read(v, t), *pLimit = tt + v->words;
+        for (r = 0; r < nPairs; r++)
+        {
+            kc_uint64 Mask = s_Truths6[Lo[r]], low2High, high2Low, *pw;
+            int j, jStep = kc_truth_word_num(Hi[r]), shift = 1 << Lo[r];
+            for (pw = tt; pw < pLimit; pw += 2 * jStep)
+                for (j = 0; j < jStep; j++)
+                {
+                    low2High = (pw[j] & Mask) >> shift;
+                    high2Low = (pw[j + jStep] << shift) & Mask;
+                    pw[j] = (pw[j] & ~Mask) | high2Low;
+                    pw[j + jStep] = (pw[j + jStep] & Mask) | low2High;
+                }
+        }
+        if (nSwaps == 0 && !fMoveWords)
+            continue;
+        // gather the words and permute the variables inside each of them
+        for (w = 0; w < v->words; w++)
+        {
+            kc_uint64 Word = tt[Map[w]];
+            for (r = 0; r < nSwaps; r++)
+                Word = (Word & Masks[r][0]) | ((Word & Masks[r][1]) << Shifts[r]) | ((Word & Masks[r][2]) >> Shifts[r]);
+            Temp[w] = Word;
+        }
+        memcpy(tt, Temp, 8 * v->words);
+    }
+}
+
+// complements the variable in the truth table (swaps its cofactors)
+static inline void kc_vt_flip_var(kc_vt *v, int ttId, int iVar)
+{
+    kc_uint64 *tt = kc_vt_read(v, ttId);
+    assert(kc_truth_word_num(iVar + 1) <= v->words);
+    if (iVar <= 5)
+    {
+        int w, shift = (1 << iVar);
+        for (w = 0; w < v->words; w++)
+            tt[w] = ((tt[w] & s_Truths6[iVar]) >> shift) | ((tt[w] & s_Truths6Neg[iVar]) << shift);
+    }
+    else
+    {
+        kc_uint64 *pLimit = tt + v->words;
+        int i, iStep = kc_truth_word_num(iVar);
+        for (; tt < pLimit; tt += 2 * iStep)
+            for (i = 0; i < iStep; i++)
+                KC_SWAP(kc_uint64, tt[i], tt[i + iStep])
+    }
+}
+
 /*************************************************************
                  Printing truth tables
 **************************************************************/
@@ -543,10 +929,20 @@ typedef struct kc_gg_
     int tid;     // the current traversal ID
     kc_vi tids;  // the last visited tranversal ID of each object
     kc_vi fans;  // the fanins of objects
+    kc_vi levs;  // the level of each object (xor-gates count as one level)
+    kc_vi wids;  // the number of the first words of the truth table of each object repeated in the rest of it
     kc_vi tops;  // the output literals
+    kc_vi stack; // the nodes to be visited by the traversal
     kc_vt funcs; // the truth tables used for temporary cofactoring
     kc_vt tts;   // the truth tables of each literal (pos and neg polarity of each object)
     kc_vt outs;  // the primary output function(s) given by the user
+    int perm[MAX_VARS]; // the variable of the user's function feeding each primary input (after reordering)
+    unsigned phase;     // the variables of the user's function complemented before synthesis
+    int delay;          // enables choosing expansions by the number of levels before the number of nodes
+    int max_level;      // the number of levels that is not exceeded if possible (0 = minimize the levels)
+    int lib;            // enables taking the functions of the bottom variables from the library of structures
+    std::atomic<int> *cancel; // the flag stopping the synthesis, whose result is then dropped (NULL = no flag)
+    size_t mem_limit;         // the memory stopping the synthesis after an output, whose result is then dropped (0 = no limit)
 } kc_gg;
 
 // reading fanins
@@ -560,8 +956,9 @@ static inline int kc_gg_is_node(kc_gg *p, int v) { return v >= 1 + p->nins; }
 static inline int kc_gg_is_pi(kc_gg *p, int v) { return v >= 1 && v <= p->nins; }
 static inline int kc_gg_is_const0(kc_gg *p, int v) { return v == 0; }
 static inline int kc_gg_pi_num(kc_gg *p) { return p->nins; }
-static inline int kc_gg_po_num(kc_gg *p) { return kc_vt_size(&p->outs); }
+static inline int kc_gg_po_num(kc_gg *p) { return kc_vi_size(&p->tops); }
 static inline int kc_gg_node_num(kc_gg *p) { return p->size - 1 - p->nins; }
+static inline int kc_gg_lit_level(kc_gg *p, int lit) { return lit < 2 ? -1 : kc_vi_read(&p->levs, kc_l2v(lit)); } // -1 for constants
 
 // managing traversal IDs
 static inline int kc_gg_tid_increment(kc_gg *p)
@@ -583,6 +980,14 @@ static inline int kc_gg_tid_update(kc_gg *p, int v)
     return kc_gg_tid_set_cur(p, v);
 }
 
+// the widths of the truth tables of the constant and the inputs
+static inline void kc_gg_fill_widths(kc_gg *gg)
+{
+    kc_vi_push(&gg->wids, 1);
+    for (int i = 0; i < gg->nins; i++)
+        kc_vi_push(&gg->wids, kc_truth_word_num(i + 1));
+}
+
 // constructor and destructor
 static inline kc_gg *kc_gg_start(int nins, kc_vt *outs)
 {
@@ -595,12 +1000,51 @@ static inline kc_gg *kc_gg_start(int nins, kc_vt *outs)
     kc_vi_fill(&gg->tids, gg->size, 0);
     kc_vi_start(&gg->fans, 2 * gg->cap);
     kc_vi_fill(&gg->fans, 2 * gg->size, -1);
+    kc_vi_start(&gg->levs, gg->cap);
+    kc_vi_fill(&gg->levs, gg->size, 0);
+    kc_vi_start(&gg->wids, gg->cap);
+    kc_gg_fill_widths(gg);
     kc_vi_start(&gg->tops, outs->size);
+    kc_vi_start(&gg->stack, 1000);
     kc_vt_start(&gg->funcs, 3 * gg->size, kc_truth_word_num(nins));
     kc_vt_start_truth(&gg->tts, nins);
     kc_vt_dup(&gg->outs, outs);
+    for (int i = 0; i < MAX_VARS; i++)
+        gg->perm[i] = i;
+    gg->phase = 0;
+    gg->delay = 0;
+    gg->max_level = 0;
+    gg->lib = 0;
+    gg->cancel = NULL;
+    gg->mem_limit = 0;
     return gg;
 }
+// restarts the graph for a new problem while keeping the allocated memory
+static inline void kc_gg_restart(kc_gg *gg, int nins, kc_vt *outs)
+{
+    int i, words = kc_truth_word_num(nins);
+    gg->nins = nins;
+    gg->size = 1 + nins;
+    gg->tid = 1;
+    kc_vi_resize(&gg->tids, 0);
+    kc_vi_fill(&gg->tids, gg->size, 0);
+    kc_vi_resize(&gg->fans, 0);
+    kc_vi_fill(&gg->fans, 2 * gg->size, -1);
+    kc_vi_resize(&gg->levs, 0);
+    kc_vi_fill(&gg->levs, gg->size, 0);
+    kc_vi_resize(&gg->wids, 0);
+    kc_gg_fill_widths(gg);
+    kc_vi_resize(&gg->tops, 0);
+    kc_vt_restart(&gg->funcs, 3 * gg->size, words);
+    kc_vt_restart(&gg->tts, 2 * gg->size, words);
+    kc_vt_fill_truth(&gg->tts, nins);
+    kc_vt_restart(&gg->outs, outs->size, words);
+    for (i = 0; i < outs->size; i++)
+        kc_vt_move(&gg->outs, outs, i);
+    for (i = 0; i < MAX_VARS; i++)
+        gg->perm[i] = i;
+    gg->phase = 0;
+}
 static inline void kc_gg_stop(kc_gg *gg)
 {
     if (gg == NULL)
@@ -610,22 +1054,47 @@ static inline void kc_gg_stop(kc_gg *gg)
     kc_vt_stop(&gg->tts);
     kc_vi_stop(&gg->tids);
     kc_vi_stop(&gg->fans);
+    kc_vi_stop(&gg->levs);
+    kc_vi_stop(&gg->wids);
     kc_vi_stop(&gg->tops);
+    kc_vi_stop(&gg->stack);
     free(gg);
 }
 
+// the memory used by the graph in bytes
+static inline size_t kc_gg_memory(kc_gg *gg)
+{
+    size_t Mem = sizeof(kc_gg);
+    Mem += 4 * ((size_t)gg->tids.cap + gg->fans.cap + gg->levs.cap + gg->wids.cap + gg->tops.cap + gg->stack.cap);
+    Mem += 8 * ((size_t)gg->funcs.cap * gg->funcs.words + (size_t)gg->tts.cap * gg->tts.words + (size_t)gg->outs.cap * gg->outs.words);
+    return Mem;
+}
+
 // managing internal nodes
 static inline int kc_gg_hash_node(kc_gg *gg, int lit1, int lit2, int ttId)
 {
     int i;
+    KC_PROF_COUNT(KC_PROF_HASH_NODE);
+    KC_PROF_TIME(KC_PROF_HASH_NODE);
     // compare nodes (structural hashing)
     for (i = 1 + gg->nins; i < gg->size; i++)
+    {
+        KC_PROF_COUNT(KC_PROF_PROBES);
         if (kc_gg_fanin(gg, i, 0) == lit1 && kc_gg_fanin(gg, i, 1) == lit2)
-            return kc_v2l(i, 0);
-    // compare functions (functional hashing)
-    for (i = 0; i < 2 * gg->size; i++)
-        if (kc_vt_is_equal(&gg->tts, ttId, i))
-            return i;
+            return KC_PROF_COUNT(KC_PROF_STRASH_HIT), kc_v2l(i, 0);
+    }
+    // compare functions (functional hashing) of the objects whose truth tables have the same width
+    int nWords = kc_vt_width(&gg->tts, ttId);
+    for (i = 0; i < 2 * gg->size; i += 2)
+    {
+        KC_PROF_COUNT(KC_PROF_PROBES);
+        if (kc_vi_read(&gg->wids, i >> 1) != nWords)
+            continue;
+        if (kc_vt_is_equal2_words(&gg->tts, ttId, &gg->tts, i, nWords))
+            return KC_PROF_COUNT(KC_PROF_FHASH_HIT), i;
+        if (kc_vt_is_equal2_words(&gg->tts, ttId, &gg->tts, i + 1, nWords))
+            return KC_PROF_COUNT(KC_PROF_FHASH_HIT), i + 1;
+    }
     return -1;
 }
 static inline int kc_gg_append_node(kc_gg *gg, int lit1, int lit2, int ttId)
@@ -633,19 +1102,31 @@ static inline int kc_gg_append_node(kc_gg *gg, int lit1, int lit2, int ttId)
     gg->size++;
     kc_vi_push(&gg->fans, lit1);
     kc_vi_push(&gg->fans, lit2);
+    kc_vi_push(&gg->levs, 1 + kc_max(kc_gg_lit_level(gg, lit1), kc_gg_lit_level(gg, lit2)));
     kc_vi_push(&gg->tids, 0);
+    kc_vi_push(&gg->wids, kc_vt_width(&gg->tts, ttId));
     kc_vt_inv(&gg->tts, ttId);
     assert(gg->tts.size == 2 * gg->size); // one truth table for each literal
     return kc_v2l(gg->size - 1, 0);
 }
 
-// managing internal functions
-static inline int kc_gg_hash_function(kc_gg *gg, int ttId)
+// managing internal functions (the function is given by the first words of its truth table, and only
+// the objects whose truth tables repeat within as many words can be equal to it)
+static inline int kc_gg_hash_function(kc_gg *gg, int ttId, int nWords)
 {
     int i;
-    for (i = 0; i < 2 * gg->size; i++)
-        if (kc_vt_is_equal2(&gg->tts, i, &gg->funcs, ttId))
-            return i;
+    KC_PROF_COUNT(KC_PROF_HASH_FUNC);
+    KC_PROF_TIME(KC_PROF_HASH_FUNC);
+    for (i = 0; i < 2 * gg->size; i += 2)
+    {
+        KC_PROF_COUNT(KC_PROF_PROBES);
+        if (kc_vi_read(&gg->wids, i >> 1) > nWords) // skip both literals of the object
+            continue;
+        if (kc_vt_is_equal2_words(&gg->tts, i, &gg->funcs, ttId, nWords))
+            return KC_PROF_COUNT(KC_PROF_HASH_HIT), i;
+        if (kc_vt_is_equal2_words(&gg->tts, i + 1, &gg->funcs, ttId, nWords))
+            return KC_PROF_COUNT(KC_PROF_HASH_HIT), i + 1;
+    }
     return -1;
 }
 
@@ -702,56 +1183,138 @@ static inline int kc_gg_or(kc_gg *gg, int lit1, int lit2) { return kc_lnot(kc_gg
 static inline int kc_gg_mux(kc_gg *gg, int ctrl, int lit1, int lit0) { return kc_gg_or(gg, kc_gg_and(gg, ctrl, lit1), kc_gg_and(gg, kc_lnot(ctrl), lit0)); }
 static inline int kc_gg_and_xor(kc_gg *gg, int ctrl, int lit1, int lit0) { return kc_gg_xor(gg, kc_gg_and(gg, ctrl, lit1), lit0); }
 
-// counting nodes
-int kc_gg_node_count_rec(kc_gg *gg, int lit)
+// counting nodes (depth-first with an explicit stack, which is safe on deep graphs)
+int kc_gg_node_count_iter(kc_gg *gg, int lit)
 {
-    int res = 1, var = kc_l2v(lit);
+    int n, res = 0, var = kc_l2v(lit);
     if (var <= gg->nins || !kc_gg_tid_update(gg, var))
         return 0;
-    res += kc_gg_node_count_rec(gg, kc_vi_read(&gg->fans, lit));
-    res += kc_gg_node_count_rec(gg, kc_vi_read(&gg->fans, kc_lnot(lit)));
+    kc_vi_resize(&gg->stack, 0);
+    kc_vi_push(&gg->stack, var);
+    while (kc_vi_size(&gg->stack) > 0)
+    {
+        var = kc_vi_pop(&gg->stack);
+        res++;
+        for (n = 0; n < 2; n++)
+        {
+            int fan = kc_l2v(kc_gg_fanin(gg, var, n));
+            if (fan > gg->nins && kc_gg_tid_update(gg, fan))
+                kc_vi_push(&gg->stack, fan);
+        }
+    }
     return res;
 }
 int kc_gg_node_count1(kc_gg *gg, int lit)
 {
     kc_gg_tid_increment(gg);
-    return kc_gg_node_count_rec(gg, lit);
+    return kc_gg_node_count_iter(gg, lit);
+}
+// counts the and-nodes after expanding the xor-gates (three and-nodes each); adds the nodes to *pNodes
+int kc_gg_and_count_iter(kc_gg *gg, int lit, int *pNodes)
+{
+    int n, res = 0, var = kc_l2v(lit);
+    if (var <= gg->nins || !kc_gg_tid_update(gg, var))
+        return 0;
+    kc_vi_resize(&gg->stack, 0);
+    kc_vi_push(&gg->stack, var);
+    while (kc_vi_size(&gg->stack) > 0)
+    {
+        var = kc_vi_pop(&gg->stack);
+        res += kc_gg_is_xor(gg, var) ? 3 : 1;
+        (*pNodes)++;
+        for (n = 0; n < 2; n++)
+        {
+            int fan = kc_l2v(kc_gg_fanin(gg, var, n));
+            if (fan > gg->nins && kc_gg_tid_update(gg, fan))
+                kc_vi_push(&gg->stack, fan);
+        }
+    }
+    return res;
+}
+int kc_gg_and_count1(kc_gg *gg, int lit, int *pNodes)
+{
+    *pNodes = 0;
+    kc_gg_tid_increment(gg);
+    return kc_gg_and_count_iter(gg, lit, pNodes);
+}
+int kc_gg_and_count(kc_gg *gg)
+{
+    int i, top, nNodes = 0, Count = 0;
+    kc_gg_tid_increment(gg);
+    kc_vi_for_each_entry(&gg->tops, top, i)
+        Count += kc_gg_and_count_iter(gg, top, &nNodes);
+    return Count;
 }
 int kc_gg_node_count2(kc_gg *gg, int lit0, int lit1)
 {
+    KC_PROF_COUNT(KC_PROF_COUNT2);
+    KC_PROF_TIME(KC_PROF_COUNT2);
     kc_gg_tid_increment(gg);
-    return kc_gg_node_count_rec(gg, lit0) + kc_gg_node_count_rec(gg, lit1);
+    return kc_gg_node_count_iter(gg, lit0) + kc_gg_node_count_iter(gg, lit1);
 }
 int kc_gg_node_count(kc_gg *gg)
 {
     int i, top, Count = 0;
     kc_gg_tid_increment(gg);
     kc_vi_for_each_entry(&gg->tops, top, i)
-        Count += kc_gg_node_count_rec(gg, top);
+        Count += kc_gg_node_count_iter(gg, top);
     return Count;
 }
 
 // counting levels
-int kc_gg_level_rec(kc_gg *gg, int *levs, int lit)
-{
-    int res0, res1, var = kc_l2v(lit);
-    if (var <= gg->nins || !kc_gg_tid_update(gg, var))
-        return levs[var];
-    res0 = kc_gg_level_rec(gg, levs, kc_vi_read(&gg->fans, lit));
-    res1 = kc_gg_level_rec(gg, levs, kc_vi_read(&gg->fans, kc_lnot(lit)));
-    return (levs[var] = 1 + kc_max(res0, res1));
-}
 int kc_gg_level(kc_gg *gg)
 {
     int i, top, levMax = 0;
-    int *levs = (int *)calloc(sizeof(int), gg->size);
-    kc_gg_tid_increment(gg);
     kc_vi_for_each_entry(&gg->tops, top, i)
-        levMax = kc_max(levMax, kc_gg_level_rec(gg, levs, top));
-    free(levs);
+        levMax = kc_max(levMax, kc_gg_lit_level(gg, top));
     return levMax;
 }
 
+// removes the nodes unreachable from the outputs and renumbers the remaining ones in the same (topological) order,
+// so that the later hash scans and traversals touch only the used nodes; returns the number of removed nodes
+static inline int kc_gg_compact(kc_gg *gg)
+{
+    int v, i, top, nOld = gg->size, nNew = 1 + gg->nins;
+    std::vector<int> Map(2 * gg->size);
+    kc_gg_node_count(gg); // mark the used nodes
+    for (i = 0; i < 2 * nNew; i++)
+        Map[i] = i;
+    for (v = 1 + gg->nins; v < gg->size; v++)
+        if (kc_gg_tid_is_cur(gg, v))
+        {
+            // the map preserves the order of literals, so the order of fanins marking xor-gates is kept
+            Map[2 * v] = 2 * nNew, Map[2 * v + 1] = 2 * nNew + 1;
+            kc_vi_write(&gg->fans, 2 * nNew, Map[kc_gg_fanin(gg, v, 0)]);
+            kc_vi_write(&gg->fans, 2 * nNew + 1, Map[kc_gg_fanin(gg, v, 1)]);
+            kc_vi_write(&gg->levs, nNew, kc_vi_read(&gg->levs, v));
+            kc_vi_write(&gg->wids, nNew, kc_vi_read(&gg->wids, v));
+            kc_vi_write(&gg->tids, nNew, kc_vi_read(&gg->tids, v));
+            memmove(kc_vt_read(&gg->tts, 2 * nNew), kc_vt_read(&gg->tts, 2 * v), 16 * gg->tts.words);
+            nNew++;
+        }
+    gg->size = nNew;
+    kc_vi_resize(&gg->fans, 2 * nNew);
+    kc_vi_resize(&gg->levs, nNew);
+    kc_vi_resize(&gg->wids, nNew);
+    kc_vi_resize(&gg->tids, nNew);
+    kc_vt_resize(&gg->tts, 2 * nNew);
+    kc_vi_for_each_entry(&gg->tops, top, i)
+        kc_vi_write(&gg->tops, i, Map[top]);
+    return nOld - nNew;
+}
+
+// the cost of the result used to compare expansions and variable orders: the number of nodes, preceded
+// by the number of levels in the delay mode (the levels do not matter if they do not exceed the bound)
+static inline long long kc_gg_cost(kc_gg *gg, int nLevels, int nNodes)
+{
+    if (!gg->delay || (gg->max_level > 0 && nLevels <= gg->max_level))
+        return nNodes;
+    return ((long long)nLevels << 32) | nNodes;
+}
+static inline int kc_cost_nodes(long long Cost) { return (int)(Cost & 0x7FFFFFFF); }
+// the level of the and/xor-gate with the fanins on the given levels (-1 stands for a constant, which is propagated)
+static inline int kc_level_gate(int lev1, int lev2) { return lev1 < 0 ? lev2 : lev2 < 0 ? lev1 : 1 + kc_max(lev1, lev2); }
+
 // printing the graph
 void kc_gg_print_lit(int lit, int nVars)
 {
@@ -774,6 +1337,7 @@ void kc_gg_print(kc_gg *gg, int verbose)
         return;
     }
     // mark used nodes with the new travId
+    kc_gg_node_count(gg);
     nLevels = kc_gg_level(gg);
     // print const and inputs
     if (fPrintTruths)
@@ -815,12 +1379,17 @@ void kc_gg_print(kc_gg *gg, int verbose)
 }
 
 // duplicates AIG while only copying used nodes (also expands xors into ands as needed)
+// (the inputs of the copy follow the variable order of the user's function)
 kc_gg *kc_gg_dup(kc_gg *gg, int only_and)
 {
     kc_gg *ggNew = kc_gg_start(gg->nins, &gg->outs);
     int i, top, *pCopy = (int *)calloc(sizeof(int), 2 * gg->size);
-    for (i = 0; i < 2 * (1 + gg->nins); i++)
-        pCopy[i] = i;
+    pCopy[0] = 0, pCopy[1] = 1;
+    for (i = 0; i < gg->nins; i++)
+    {
+        int c = (gg->phase >> gg->perm[i]) & 1;
+        pCopy[2 * (1 + i)] = kc_v2l(1 + gg->perm[i], c), pCopy[2 * (1 + i) + 1] = kc_v2l(1 + gg->perm[i], !c);
+    }
     for (i = 1 + gg->nins; i < gg->size; i++)
         if (kc_gg_tid_is_cur(gg, i))
         {
@@ -850,93 +1419,417 @@ void kc_gg_verify(kc_gg *gg)
     if (nFailed == 0)
         printf("Verification succeeded.  ");
 }
+// compares truth tables against the specification without printing; returns the number of failed outputs
+int kc_gg_verify_quiet(kc_gg *gg)
+{
+    int i, top, nFailed = 0;
+    kc_vi_for_each_entry(&gg->tops, top, i)
+        nFailed += !kc_vt_is_equal2(&gg->outs, i, &gg->tts, top);
+    return nFailed;
+}
 
 /*************************************************************
                     AIGER interface
 **************************************************************/
 
-static void kc_aiger_write_uint(FILE *pFile, unsigned x)
+static void kc_aiger_write_uint(std::string &str, unsigned x)
 {
     unsigned char ch;
     while (x & ~0x7f)
     {
         ch = (x & 0x7f) | 0x80;
-        fputc(ch, pFile);
+        str.push_back((char)ch);
         x >>= 7;
     }
     ch = x;
-    fputc(ch, pFile);
+    str.push_back((char)ch);
 }
-static void kc_aiger_write(char *pFileName, int *pObjs, int nObjs, int nIns, int nLatches, int nOuts, int nAnds, int *pOuts)
+static unsigned kc_aiger_read_uint(FILE *pFile)
 {
-    std::string str(pFileName);
-    FILE *pFile = fopen(("./outputs/" + str).c_str(), "wb");
+    unsigned x = 0;
+    int i = 0, ch;
+    while ((ch = fgetc(pFile)) != EOF && (ch & 0x80))
+        x |= (unsigned)(ch & 0x7f) << (7 * i++);
+    return x | ((unsigned)(ch == EOF ? 0 : ch) << (7 * i));
+}
+// writes the AIGER file into memory (for example, to be sent over a socket)
+static void kc_aiger_write_str(std::string &str, int *pObjs, int nObjs, int nIns, int nLatches, int nOuts, int nAnds, int *pOuts)
+{
+    char Buffer[100];
     int i;
-    if (pFile == NULL)
-    {
-        fprintf(stdout, "kc_aiger_write(): Cannot open the output file \"%s\".\n", pFileName);
-        return;
-    }
-    fprintf(pFile, "aig %d %d %d %d %d\n", nIns + nLatches + nAnds, nIns, nLatches, nOuts, nAnds);
+    sprintf(Buffer, "aig %d %d %d %d %d\n", nIns + nLatches + nAnds, nIns, nLatches, nOuts, nAnds);
+    str += Buffer;
     for (i = 0; i < nLatches; i++)
-        fprintf(pFile, "%d\n", pOuts[nOuts + i]);
+        sprintf(Buffer, "%d\n", pOuts[nOuts + i]), str += Buffer;
     for (i = 0; i < nOuts; i++)
-        fprintf(pFile, "%d\n", pOuts[i]);
+        sprintf(Buffer, "%d\n", pOuts[i]), str += Buffer;
     for (i = 0; i < nAnds; i++)
     {
         int uLit = 2 * (1 + nIns + nLatches + i);
         int uLit0 = pObjs[uLit + 0];
         int uLit1 = pObjs[uLit + 1];
-        kc_aiger_write_uint(pFile, uLit - uLit1);
-        kc_aiger_write_uint(pFile, uLit1 - uLit0);
+        kc_aiger_write_uint(str, uLit - uLit1);
+        kc_aiger_write_uint(str, uLit1 - uLit0);
     }
-    fprintf(pFile, "c\n");
-    fclose(pFile);
+    str += "c\n";
 }
-static void kc_gg_aiger_write(char *pFileName, kc_gg *gg, int fVerbose)
+static void kc_aiger_write_file(FILE *pFile, int *pObjs, int nObjs, int nIns, int nLatches, int nOuts, int nAnds, int *pOuts)
 {
-    kc_gg *ggNew = kc_gg_dup(gg, 1);
-    // kc_gg_print( ggNew, fVerbose );
-    kc_aiger_write(pFileName, kc_vi_array(&ggNew->fans), -1, kc_gg_pi_num(ggNew), 0, kc_gg_po_num(ggNew), kc_gg_node_num(ggNew), kc_vi_array(&ggNew->tops));
-    if (fVerbose)
-        printf("Written graph with %d inputs, %d outputs, and %d and-nodes into AIGER file \"%s\".\n",
-               kc_gg_pi_num(ggNew), kc_gg_po_num(ggNew), kc_gg_node_num(ggNew), pFileName);
-    kc_gg_stop(ggNew);
+    std::string str;
+    kc_aiger_write_str(str, pObjs, nObjs, nIns, nLatches, nOuts, nAnds, pOuts);
+    fwrite(str.data(), 1, str.size(), pFile);
 }
-
-/*************************************************************
-                  Permutation generation
-**************************************************************/
-
-// generate next permutation in lexicographic order
-static void kc_get_next_perm(int *currPerm, int nVars, kc_vt *tts)
+static void kc_aiger_write(char *pFileName, int *pObjs, int nObjs, int nIns, int nLatches, int nOuts, int nAnds, int *pOuts)
 {
-    int t, i = nVars - 1;
-    while (i >= 0 && currPerm[i - 1] >= currPerm[i])
-        i--;
-    if (i >= 0)
+    std::string str(pFileName);
+    FILE *pFile = fopen(("./outputs/" + str).c_str(), "wb");
+    if (pFile == NULL)
     {
-        int j = nVars;
-        while (j > i && currPerm[j - 1] <= currPerm[i - 1])
-            j--;
-        KC_SWAP(int, currPerm[i - 1], currPerm[j - 1])
-        if (tts)
-            for (t = 0; t < tts->size; t++)
-                kc_vt_swap_vars(tts, t, i - 1, j - 1);
-        i++;
-        j = nVars;
-        while (i < j)
-        {
-            KC_SWAP(int, currPerm[i - 1], currPerm[j - 1])
-            if (tts)
-                for (t = 0; t < tts->size; t++)
-                    kc_vt_swap_vars(tts, t, i - 1, j - 1);
-            i++;
-            j--;
-        }
+        fprintf(stdout, "kc_aiger_write(): Cannot open the output file \"%s\".\n", pFileName);
+        return;
     }
+    kc_aiger_write_file(pFile, pObjs, nObjs, nIns, nLatches, nOuts, nAnds, pOuts);
+    fclose(pFile);
 }
-static int kc_factorial(int nVars)
+// the and-only AIG built by expanding the graph with constant-time structural and functional hashing
+typedef struct kc_aig_
+{
+    std::vector<int> objs;                      // the fanins of the objects (const0, the inputs, and the and-nodes)
+    std::vector<int> phases;                    // whether the truth table of the object is complemented
+    std::unordered_map<long long, int> strash;  // the and-nodes by their fanins
+    std::unordered_map<kc_uint64, int> fhash;   // the objects by their truth tables
+    kc_vt tts;                                  // the truth tables of the objects (normalized to have the first bit 0)
+} kc_aig;
+
+// looks up the last truth table among the functions of the objects; returns the literal of the object if it is found,
+// otherwise keeps the normalized truth table for the next object and returns -1
+static inline int kc_aig_lookup_function(kc_aig *p)
+{
+    int i, id = p->tts.size - 1, c = 0;
+    kc_uint64 *pT = kc_vt_read(&p->tts, id);
+    if (pT[0] & 1)
+        for (c = 1, i = 0; i < p->tts.words; i++)
+            pT[i] = ~pT[i];
+    for (kc_uint64 Key = kc_vt_hash(&p->tts, id);; Key++)
+    {
+        std::unordered_map<kc_uint64, int>::iterator it = p->fhash.find(Key);
+        if (it == p->fhash.end())
+        {
+            p->fhash[Key] = id;
+            p->phases.push_back(c);
+            return -1;
+        }
+        if (kc_vt_is_equal(&p->tts, it->second, id))
+        {
+            kc_vt_shrink(&p->tts, 1);
+            return kc_v2l(it->second, c ^ p->phases[it->second]);
+        }
+    }
+}
+// returns the literal of the and-node with the given fanins after adding it unless the same node or function is there
+static inline int kc_aig_and(kc_aig *p, int lit0, int lit1)
+{
+    int i;
+    if (lit0 > lit1)
+        KC_SWAP(int, lit0, lit1)
+    if (lit0 == 0 || (lit0 ^ lit1) == 1)
+        return 0;
+    if (lit0 == 1 || lit0 == lit1)
+        return lit1;
+    long long Key = ((long long)lit0 << 32) | lit1;
+    std::unordered_map<long long, int>::iterator it = p->strash.find(Key);
+    if (it != p->strash.end())
+        return it->second;
+    kc_uint64 *pT = kc_vt_append(&p->tts);
+    kc_uint64 *pT0 = kc_vt_read(&p->tts, kc_l2v(lit0)), m0 = (kc_l2c(lit0) ^ p->phases[kc_l2v(lit0)]) ? ~(kc_uint64)0 : 0;
+    kc_uint64 *pT1 = kc_vt_read(&p->tts, kc_l2v(lit1)), m1 = (kc_l2c(lit1) ^ p->phases[kc_l2v(lit1)]) ? ~(kc_uint64)0 : 0;
+    for (i = 0; i < p->tts.words; i++)
+        pT[i] = (pT0[i] ^ m0) & (pT1[i] ^ m1);
+    int Lit = kc_aig_lookup_function(p);
+    if (Lit < 0)
+    {
+        p->objs.push_back(lit0);
+        p->objs.push_back(lit1);
+        Lit = (int)p->objs.size() - 2;
+        assert(kc_l2v(Lit) == p->tts.size - 1);
+    }
+    return p->strash[Key] = Lit;
+}
+// expands the used nodes into and-nodes in one pass (each xor-gate becomes three and-nodes);
+// Objs receives the fanins of the AIGER objects (the inputs follow the variable order of the user's function)
+// and Outs the output literals; returns the number of and-nodes
+static int kc_gg_aiger_expand(kc_gg *gg, std::vector<int> &Objs, std::vector<int> &Outs)
+{
+    int i, v, top, Inputs[MAX_VARS];
+    kc_aig Aig, *p = &Aig;
+    std::vector<int> Copy(2 * gg->size, -1);
+    kc_gg_node_count(gg); // mark the used nodes
+    // create the constant and the inputs
+    p->objs.assign(2 * (1 + gg->nins), -1);
+    kc_vt_start(&p->tts, 2 * gg->size, gg->tts.words);
+    kc_vt_move(&p->tts, &gg->tts, 0);
+    kc_aig_lookup_function(p);
+    for (i = 0; i < gg->nins; i++)
+        Inputs[gg->perm[i]] = i;
+    for (i = 0; i < gg->nins; i++)
+    {
+        kc_vt_move(&p->tts, &gg->tts, 2 * (1 + Inputs[i]) + ((gg->phase >> i) & 1));
+        kc_aig_lookup_function(p);
+    }
+    Copy[0] = 0, Copy[1] = 1;
+    for (i = 0; i < gg->nins; i++)
+    {
+        int c = (gg->phase >> gg->perm[i]) & 1;
+        Copy[2 * (1 + i)] = kc_v2l(1 + gg->perm[i], c), Copy[2 * (1 + i) + 1] = kc_v2l(1 + gg->perm[i], !c);
+    }
+    for (v = 1 + gg->nins; v < gg->size; v++)
+        if (kc_gg_tid_is_cur(gg, v))
+        {
+            int lit0 = Copy[kc_gg_fanin(gg, v, 0)];
+            int lit1 = Copy[kc_gg_fanin(gg, v, 1)];
+            if (!kc_gg_is_xor(gg, v))
+                Copy[2 * v] = kc_aig_and(p, lit0, lit1);
+            else
+            {
+                int n1 = kc_aig_and(p, lit0, kc_lnot(lit1));
+                int n2 = kc_aig_and(p, kc_lnot(lit0), lit1);
+                Copy[2 * v] = kc_lnot(kc_aig_and(p, kc_lnot(n1), kc_lnot(n2)));
+            }
+            Copy[2 * v + 1] = kc_lnot(Copy[2 * v]);
+        }
+    Outs.clear();
+    kc_vi_for_each_entry(&gg->tops, top, i)
+        Outs.push_back(Copy[top]);
+    kc_vt_stop(&p->tts);
+    Objs.swap(p->objs);
+    return (int)Objs.size() / 2 - 1 - gg->nins;
+}
+// writes the graph into memory; returns the number of and-nodes
+static int kc_gg_aiger_write_str(std::string &str, kc_gg *gg)
+{
+    std::vector<int> Objs, Outs;
+    int nAnds = kc_gg_aiger_expand(gg, Objs, Outs);
+    kc_aiger_write_str(str, Objs.data(), -1, kc_gg_pi_num(gg), 0, kc_gg_po_num(gg), nAnds, Outs.data());
+    return nAnds;
+}
+// writes the graph into an open file (for example, an archive); returns the number of and-nodes
+static int kc_gg_aiger_write_file(FILE *pFile, kc_gg *gg)
+{
+    std::string str;
+    int nAnds = kc_gg_aiger_write_str(str, gg);
+    fwrite(str.data(), 1, str.size(), pFile);
+    return nAnds;
+}
+static void kc_gg_aiger_write(char *pFileName, kc_gg *gg, int fVerbose)
+{
+    std::vector<int> Objs, Outs;
+    int nAnds = kc_gg_aiger_expand(gg, Objs, Outs);
+    kc_aiger_write(pFileName, Objs.data(), -1, kc_gg_pi_num(gg), 0, kc_gg_po_num(gg), nAnds, Outs.data());
+    if (fVerbose)
+        printf("Written graph with %d inputs, %d outputs, and %d and-nodes into AIGER file \"%s\".\n",
+               kc_gg_pi_num(gg), kc_gg_po_num(gg), nAnds, pFileName);
+}
+
+/*************************************************************
+                 BLIF and Verilog interface
+**************************************************************/
+
+// prints the name of the signal of the literal into the buffer; returns 1 if the literal is complemented
+// (the inputs follow the variable order of the user's function)
+static inline int kc_gg_lit_name(kc_gg *gg, int lit, char *pBuffer)
+{
+    int v = kc_l2v(lit), c = kc_l2c(lit);
+    if (kc_gg_is_pi(gg, v))
+        sprintf(pBuffer, "x%d", gg->perm[v - 1]), c ^= (gg->phase >> gg->perm[v - 1]) & 1;
+    else
+        sprintf(pBuffer, "n%d", v);
+    return c;
+}
+// writes the used nodes as a BLIF netlist of and-gates and xor-gates with complemented inputs
+static void kc_gg_blif_write_file(FILE *pFile, kc_gg *gg, const char *pModel)
+{
+    char Name0[16], Name1[16];
+    int i, v, top;
+    kc_gg_node_count(gg); // mark the used nodes
+    fprintf(pFile, ".model %s\n.inputs", pModel);
+    for (i = 0; i < gg->nins; i++)
+        fprintf(pFile, " x%d", i);
+    fprintf(pFile, "\n.outputs");
+    for (i = 0; i < kc_gg_po_num(gg); i++)
+        fprintf(pFile, " y%d", i);
+    fprintf(pFile, "\n");
+    for (v = 1 + gg->nins; v < gg->size; v++)
+        if (kc_gg_tid_is_cur(gg, v))
+        {
+            int c0 = kc_gg_lit_name(gg, kc_gg_fanin(gg, v, 0), Name0);
+            int c1 = kc_gg_lit_name(gg, kc_gg_fanin(gg, v, 1), Name1);
+            fprintf(pFile, ".names %s %s n%d\n", Name0, Name1, v);
+            if (!kc_gg_is_xor(gg, v))
+                fprintf(pFile, "%d%d 1\n", !c0, !c1);
+            else
+                fprintf(pFile, "%d%d 1\n%d%d 1\n", c0, !c1, !c0, c1);
+        }
+    kc_vi_for_each_entry(&gg->tops, top, i)
+    {
+        if (top < 2)
+            fprintf(pFile, ".names y%d\n%s", i, top ? "1\n" : "");
+        else
+        {
+            int c = kc_gg_lit_name(gg, top, Name0);
+            fprintf(pFile, ".names %s y%d\n%d 1\n", Name0, i, !c);
+        }
+    }
+    fprintf(pFile, ".end\n");
+}
+// writes the used nodes as a structural Verilog module with and-gates and xor-gates
+static void kc_gg_verilog_write_file(FILE *pFile, kc_gg *gg, const char *pModel)
+{
+    char Name0[16], Name1[16];
+    int i, v, top;
+    kc_gg_node_count(gg); // mark the used nodes
+    fprintf(pFile, "module %s (", pModel);
+    for (i = 0; i < gg->nins; i++)
+        fprintf(pFile, "x%d, ", i);
+    for (i = 0; i < kc_gg_po_num(gg); i++)
+        fprintf(pFile, "y%d%s", i, i == kc_gg_po_num(gg) - 1 ? ");\n" : ", ");
+    for (i = 0; i < gg->nins; i++)
+        fprintf(pFile, "  input x%d;\n", i);
+    for (i = 0; i < kc_gg_po_num(gg); i++)
+        fprintf(pFile, "  output y%d;\n", i);
+    for (v = 1 + gg->nins; v < gg->size; v++)
+        if (kc_gg_tid_is_cur(gg, v))
+            fprintf(pFile, "  wire n%d;\n", v);
+    for (v = 1 + gg->nins; v < gg->size; v++)
+        if (kc_gg_tid_is_cur(gg, v))
+        {
+            int c0 = kc_gg_lit_name(gg, kc_gg_fanin(gg, v, 0), Name0);
+            int c1 = kc_gg_lit_name(gg, kc_gg_fanin(gg, v, 1), Name1);
+            fprintf(pFile, "  assign n%d = %s%s %c %s%s;\n", v, c0 ? "~" : "", Name0, kc_gg_is_xor(gg, v) ? '^' : '&', c1 ? "~" : "", Name1);
+        }
+    kc_vi_for_each_entry(&gg->tops, top, i)
+    {
+        if (top < 2)
+            fprintf(pFile, "  assign y%d = 1'b%d;\n", i, top);
+        else
+        {
+            int c = kc_gg_lit_name(gg, top, Name0);
+            fprintf(pFile, "  assign y%d = %s%s;\n", i, c ? "~" : "", Name0);
+        }
+    }
+    fprintf(pFile, "endmodule\n");
+}
+// writes the netlist with xor-gates into the output directory (Verilog if the file name ends with ".v", otherwise BLIF)
+static void kc_gg_netlist_write(char *pFileName, kc_gg *gg, int fVerbose)
+{
+    std::string str(pFileName), model = str.substr(0, str.find_first_of("."));
+    for (size_t k = 0; k < model.size(); k++)
+        if (!isalnum((unsigned char)model[k]))
+            model[k] = '_';
+    if (model.empty() || isdigit((unsigned char)model[0]))
+        model = "m_" + model;
+    FILE *pFile = fopen(("./outputs/" + str).c_str(), "wb");
+    if (pFile == NULL)
+    {
+        fprintf(stdout, "kc_gg_netlist_write(): Cannot open the output file \"%s\".\n", pFileName);
+        return;
+    }
+    int fVerilog = kc_file_has_ext(pFileName, ".v");
+    if (fVerilog)
+        kc_gg_verilog_write_file(pFile, gg, model.c_str());
+    else
+        kc_gg_blif_write_file(pFile, gg, model.c_str());
+    fclose(pFile);
+    if (fVerbose)
+        printf("Written graph with %d inputs, %d outputs, and %d nodes into %s file \"%s\".\n",
+               kc_gg_pi_num(gg), kc_gg_po_num(gg), kc_gg_node_count(gg), fVerilog ? "Verilog" : "BLIF", pFileName);
+}
+
+/*************************************************************
+                  Permutation generation
+**************************************************************/
+
+// generate next permutation in lexicographic order (the truth tables, if given, are permuted in one pass)
+static void kc_get_next_perm(int *currPerm, int nVars, kc_vt *tts)
+{
+    int t, i = nVars - 1, From[MAX_VARS], Swap[2], nSwaps = 0;
+    for (t = 0; t < nVars; t++)
+        From[t] = t;
+    while (i > 0 && currPerm[i - 1] >= currPerm[i])
+        i--;
+    if (i > 0)
+    {
+        int j = nVars;
+        while (j > i && currPerm[j - 1] <= currPerm[i - 1])
+            j--;
+        KC_SWAP(int, currPerm[i - 1], currPerm[j - 1])
+        KC_SWAP(int, From[i - 1], From[j - 1])
+        Swap[0] = i - 1, Swap[1] = j - 1, nSwaps++;
+        i++;
+        j = nVars;
+        while (i < j)
+        {
+            KC_SWAP(int, currPerm[i - 1], currPerm[j - 1])
+            if (currPerm[i - 1] != currPerm[j - 1]) // equal entries stand for symmetric variables
+            {
+                KC_SWAP(int, From[i - 1], From[j - 1])
+                Swap[0] = i - 1, Swap[1] = j - 1, nSwaps++;
+            }
+            i++;
+            j--;
+        }
+    }
+    if (tts && nSwaps == 1)
+        for (t = 0; t < tts->size; t++)
+            kc_vt_swap_vars(tts, t, Swap[0], Swap[1]);
+    else if (tts && nSwaps > 1)
+        kc_vt_permute(tts, From, nVars);
+}
+// reorders the variables in the truth tables so that position k holds variable pTarget[k] (pPos[k] is the current one)
+static void kc_vt_reorder(kc_vt *tts, int *pPos, int *pTarget, int nVars)
+{
+    int t, k, p, From[MAX_VARS], Swap[2], nSwaps = 0;
+    for (k = 0; k < nVars; k++)
+        From[k] = k;
+    for (k = 0; k < nVars; k++)
+    {
+        for (p = k; pPos[p] != pTarget[k]; p++)
+            ;
+        if (p == k)
+            continue;
+        KC_SWAP(int, From[k], From[p])
+        KC_SWAP(int, pPos[k], pPos[p])
+        Swap[0] = k, Swap[1] = p, nSwaps++;
+    }
+    if (nSwaps == 1)
+        for (t = 0; t < tts->size; t++)
+            kc_vt_swap_vars(tts, t, Swap[0], Swap[1]);
+    else if (nSwaps > 1)
+        kc_vt_permute(tts, From, nVars);
+}
+// computes the permutation of the given index in the order generated by kc_get_next_perm starting from the sorted labels
+// (the factorial number system, where the equal labels standing for symmetric variables are not distinguished)
+static void kc_get_perm_by_index(int *pLabels, int nVars, long long Index, int *pPerm)
+{
+    int i, k, m, Rest[MAX_VARS], Count[MAX_VARS] = {0};
+    long long Total = 1; // the number of permutations of the remaining labels
+    for (i = 0; i < nVars; i++)
+        Rest[i] = pLabels[i], Total = Total * (i + 1) / ++Count[pLabels[i]];
+    assert(Index >= 0 && Index < Total);
+    for (k = 0, m = nVars; k < nVars; k++, m--)
+        for (i = 0; i < m; i += Count[Rest[i]])
+        {
+            long long Num = Total * Count[Rest[i]] / m; // the number of permutations starting with this label
+            if (Index >= Num)
+            {
+                Index -= Num;
+                continue;
+            }
+            pPerm[k] = Rest[i], Total = Num, Count[Rest[i]]--;
+            memmove(Rest + i, Rest + i + 1, sizeof(int) * (m - 1 - i));
+            break;
+        }
+}
+static int kc_factorial(int nVars)
 {
     int i, Res = 1;
     for (i = 1; i <= nVars; i++)
@@ -965,317 +1858,3361 @@ extern "C"
 }
 
 /*************************************************************
-                  Recursive synthesis
+             Testing truth-table operations
 **************************************************************/
 
-// takes the function and the top-most variable; returns literal of the circuit
-int synthesis_and_rec(kc_gg *gg, int ttId, int varId)
+static inline kc_uint64 kc_random64(kc_uint64 *pState)
 {
-    int iLit;
-    if ((iLit = kc_gg_hash_function(gg, ttId)) >= 0)
-        return iLit;
-    // if ( kc_vt_is_const0(&gg->funcs, ttId) ) return 0;
-    // if ( kc_vt_is_const1(&gg->funcs, ttId) ) return 1;
-    if (!kc_vt_has_var(&gg->funcs, ttId, varId))
-        return synthesis_and_rec(gg, ttId, varId - 1);
-    int f0 = kc_vt_cof0(&gg->funcs, ttId, varId);
-    int f1 = kc_vt_cof1(&gg->funcs, ttId, varId);
-    int lit0 = synthesis_and_rec(gg, f0, varId - 1);
-    int lit1 = synthesis_and_rec(gg, f1, varId - 1);
-    kc_vt_shrink(&gg->funcs, 2);
-    return kc_gg_mux(gg, kc_v2l(1 + varId, 0), lit1, lit0);
+    kc_uint64 x = *pState;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *pState = x;
 }
-int synthesis_xor_rec(kc_gg *gg, int ttId, int varId)
+// naive bit-level reference
+static inline int kc_vt_bit(kc_vt *v, int ttId, int m) { return (int)((kc_vt_read(v, ttId)[m >> 6] >> (m & 63)) & 1); }
+static inline int kc_bit_swap(int m, int i, int j) { return ((m >> i) & 1) == ((m >> j) & 1) ? m : m ^ (1 << i) ^ (1 << j); }
+
+// compares the operations on two random truth tables against the bit-level reference; returns the number of failures
+static inline int kc_vt_check(int nvars, kc_uint64 *pState)
 {
-    int iLit;
-    if ((iLit = kc_gg_hash_function(gg, ttId)) >= 0)
-        return iLit;
-    // if ( kc_vt_is_const0(&gg->funcs, ttId) ) return 0;
-    // if ( kc_vt_is_const1(&gg->funcs, ttId) ) return 1;
-    if (!kc_vt_has_var(&gg->funcs, ttId, varId))
-        return synthesis_xor_rec(gg, ttId, varId - 1);
-    int f0 = kc_vt_cof0(&gg->funcs, ttId, varId);
-    int f1 = kc_vt_cof1(&gg->funcs, ttId, varId);
-    int f2 = kc_vt_xor(&gg->funcs, f0, f1);
-    int lit0 = synthesis_xor_rec(gg, f0, varId - 1);
-    int lit1 = synthesis_xor_rec(gg, f1, varId - 1);
-    int lit2 = synthesis_xor_rec(gg, f2, varId - 1);
-    kc_vt_shrink(&gg->funcs, 3);
-    int n01 = kc_gg_node_count2(gg, lit0, lit1) + 1 + 2 * (lit0 >= 2 && lit1 >= 2);
-    int n02 = kc_gg_node_count2(gg, lit0, lit2) + 1 + 1 * (lit0 >= 2 && lit1 >= 2);
-    int n12 = kc_gg_node_count2(gg, lit1, lit2) + 1 + 1 * (lit0 >= 2 && lit1 >= 2);
-    int min = kc_min(n01, kc_min(n02, n12));
-    if (min == n01) // Shannon
-        return kc_gg_mux(gg, kc_v2l(1 + varId, 0), lit1, lit0);
-    if (min == n02) // positive Davio
-        return kc_gg_and_xor(gg, kc_v2l(1 + varId, 0), lit2, lit0);
-    if (min == n12) // negative Davio
-        return kc_gg_and_xor(gg, kc_v2l(1 + varId, 1), lit2, lit1);
-    return -1;
+    int i, j, m, r, nBits = 1 << nvars, nFails = 0;
+    kc_vt V, *v = &V;
+    kc_vt_start(v, 8, kc_truth_word_num(nvars));
+    for (i = 0; i < 2; i++)
+        for (kc_uint64 *pA = kc_vt_append(v), *pLimit = pA + v->words; pA < pLimit; pA++)
+            *pA = kc_random64(pState);
+    for (i = 0; i < nvars; i++)
+    {
+        int c0 = kc_vt_cof0(v, 0, i), c1 = kc_vt_cof1(v, 0, i), f = v->size;
+        kc_vt_move(v, v, 0);
+        kc_vt_flip_var(v, f, i);
+        for (r = 0, m = 0; m < nBits; m++)
+        {
+            r |= kc_vt_bit(v, 0, m) != kc_vt_bit(v, 0, m ^ (1 << i));
+            nFails += kc_vt_bit(v, c0, m) != kc_vt_bit(v, 0, m & ~(1 << i));
+            nFails += kc_vt_bit(v, c1, m) != kc_vt_bit(v, 0, m | (1 << i));
+            nFails += kc_vt_bit(v, f, m) != kc_vt_bit(v, 0, m ^ (1 << i));
+        }
+        nFails += kc_vt_has_var(v, 0, i) != r;
+        nFails += kc_vt_has_var(v, c0, i) || kc_vt_has_var(v, c1, i);
+        if (i == nvars - 1) // the cofactors of the top variable given by the first words
+        {
+            int t0 = kc_vt_cof0_top(v, 0, i), t1 = kc_vt_cof1_top(v, 0, i), w = kc_truth_word_num(i);
+            nFails += !kc_vt_is_equal2_words(v, t0, v, c0, w) || !kc_vt_is_equal2_words(v, t1, v, c1, w);
+            nFails += kc_vt_has_var_top(v, 0, i) != r || kc_vt_width(v, c0) > w || kc_vt_width(v, c1) > w;
+            kc_vt_shrink(v, 2);
+        }
+        kc_vt_shrink(v, 3);
+        for (j = i + 1; j < nvars; j++)
+        {
+            kc_vt_move(v, v, 0);
+            kc_vt_swap_vars(v, 2, i, j);
+            for (m = 0; m < nBits; m++)
+                nFails += kc_vt_bit(v, 2, m) != kc_vt_bit(v, 0, kc_bit_swap(m, i, j));
+            kc_vt_shrink(v, 1);
+        }
+    }
+    // a random permutation of all variables
+    int From[MAX_VARS];
+    for (i = 0; i < nvars; i++)
+        From[i] = i;
+    for (i = nvars - 1; i > 0; i--)
+    {
+        j = (int)(kc_random64(pState) % (i + 1));
+        KC_SWAP(int, From[i], From[j])
+    }
+    kc_vt P, *p = &P; // the kernel permutes all truth tables of the array
+    kc_vt_start(p, 1, v->words);
+    kc_vt_move(p, v, 0);
+    kc_vt_permute(p, From, nvars);
+    for (m = 0; m < nBits; m++)
+    {
+        for (r = 0, i = 0; i < nvars; i++)
+            r |= ((m >> i) & 1) << From[i];
+        nFails += kc_vt_bit(p, 0, m) != kc_vt_bit(v, 0, r);
+    }
+    kc_vt_stop(p);
+    int a = kc_vt_and(v, 0, 1), x = kc_vt_xor(v, 0, 1), n = kc_vt_inv(v, 0);
+    for (m = 0; m < nBits; m++)
+    {
+        nFails += kc_vt_bit(v, a, m) != (kc_vt_bit(v, 0, m) & kc_vt_bit(v, 1, m));
+        nFails += kc_vt_bit(v, x, m) != (kc_vt_bit(v, 0, m) ^ kc_vt_bit(v, 1, m));
+        nFails += kc_vt_bit(v, n, m) == kc_vt_bit(v, 0, m);
+    }
+    kc_vt_move(v, v, 0);
+    nFails += !kc_vt_is_equal(v, 0, v->size - 1);
+    kc_vt_read(v, v->size - 1)[v->words - 1] ^= (kc_uint64)1 << 63;
+    nFails += kc_vt_is_equal(v, 0, v->size - 1);
+    kc_vt_stop(v);
+    return nFails;
+}
+
+// prints the time of one operation in nanoseconds and per 64-bit word
+static inline void kc_bench_print(const char *pName, int nvars, int iVar, int jVar, double Time, long long nOps)
+{
+    double ns = 1e9 * Time / nOps;
+    printf("%-10s %5d %4d %4d %10.2f %10.3f\n", pName, nvars, iVar, jVar, ns, ns / kc_truth_word_num(nvars));
+}
+
+extern "C"
+{
+    // checks the operations on truth tables and measures their runtime for each number of variables and each variable
+    int kc_vt_bench(int nVarsMin, int nVarsMax)
+    {
+        kc_uint64 State = 0x9E3779B97F4A7C15, Sum = 0;
+        int i, j, n, k, nFails = 0;
+        for (n = nVarsMin; n <= nVarsMax; n++)
+            nFails += kc_vt_check(n, &State);
+        printf("Checked truth-table operations for %d-%d variables against the bit-level reference: %d failures.\n",
+               nVarsMin, nVarsMax, nFails);
+        printf("%-10s %5s %4s %4s %10s %10s\n", "kernel", "nvars", "var", "var2", "ns/op", "ns/word");
+        for (n = nVarsMin; n <= nVarsMax; n++)
+        {
+            kc_vt V, *v = &V;
+            kc_vt_start(v, 8, kc_truth_word_num(n));
+            for (i = 0; i < 2; i++)
+                for (kc_uint64 *pA = kc_vt_append(v), *pLimit = pA + v->words; pA < pLimit; pA++)
+                    *pA = kc_random64(&State);
+            kc_vt_move(v, v, 0);
+            int nOps = kc_max(16, (1 << 20) / v->words);
+            double Time;
+            for (i = 0; i < n; i++)
+            {
+                Time = kc_wall_time();
+                for (k = 0; k < nOps; k++)
+                    kc_vt_cof0(v, 0, i), kc_vt_shrink(v, 1);
+                kc_bench_print("cof0", n, i, -1, kc_wall_time() - Time, nOps);
+                Time = kc_wall_time();
+                for (k = 0; k < nOps; k++)
+                    kc_vt_cof1(v, 0, i), kc_vt_shrink(v, 1);
+                kc_bench_print("cof1", n, i, -1, kc_wall_time() - Time, nOps);
+                Time = kc_wall_time();
+                for (k = 0; k < nOps; k++)
+                    Sum += kc_vt_has_var(v, 0, i);
+                kc_bench_print("has_var", n, i, -1, kc_wall_time() - Time, nOps);
+                Time = kc_wall_time();
+                for (k = 0; k < nOps; k++)
+                    kc_vt_flip_var(v, 1, i);
+                kc_bench_print("flip_var", n, i, -1, kc_wall_time() - Time, nOps);
+                for (j = i + 1; j < n; j++)
+                {
+                    Time = kc_wall_time();
+                    for (k = 0; k < nOps; k++)
+                        kc_vt_swap_vars(v, 1, i, j);
+                    kc_bench_print("swap_vars", n, i, j, kc_wall_time() - Time, nOps);
+                }
+            }
+            int From[MAX_VARS]; // reversing the order of the variables
+            for (i = 0; i < n; i++)
+                From[i] = n - 1 - i;
+            kc_vt P, *p = &P;
+            kc_vt_start(p, 1, v->words);
+            kc_vt_move(p, v, 1);
+            Time = kc_wall_time();
+            for (k = 0; k < nOps; k++)
+                kc_vt_permute(p, From, n);
+            kc_bench_print("permute", n, -1, -1, kc_wall_time() - Time, nOps);
+            Sum += kc_vt_read(p, 0)[0];
+            kc_vt_stop(p);
+            Time = kc_wall_time();
+            for (k = 0; k < nOps; k++)
+                kc_vt_and(v, 0, 1), kc_vt_shrink(v, 1);
+            kc_bench_print("and", n, -1, -1, kc_wall_time() - Time, nOps);
+            Time = kc_wall_time();
+            for (k = 0; k < nOps; k++)
+                kc_vt_xor(v, 0, 1), kc_vt_shrink(v, 1);
+            kc_bench_print("xor", n, -1, -1, kc_wall_time() - Time, nOps);
+            Time = kc_wall_time();
+            for (k = 0; k < nOps; k++)
+                kc_vt_inv(v, 0), kc_vt_shrink(v, 1);
+            kc_bench_print("inv", n, -1, -1, kc_wall_time() - Time, nOps);
+            kc_vt_move(v, v, 0);
+            Time = kc_wall_time();
+            for (k = 0; k < nOps; k++)
+                Sum += kc_vt_is_equal(v, 0, 2);
+            kc_bench_print("is_equal", n, -1, -1, kc_wall_time() - Time, nOps);
+            Sum += kc_vt_read(v, 1)[0];
+            kc_vt_stop(v);
+        }
+        printf("Checksum = %016llX\n", (unsigned long long)Sum);
+        return nFails == 0;
+    }
+}
+
+/*************************************************************
+                 Verification by simulation
+**************************************************************/
+
+#define KC_SIM_CHUNK 16   // the number of 64-bit words of the truth tables simulated at a time
+#define KC_SIM_RANDOM 256 // the number of randomly chosen words simulated by the quick verification
+
+// simulates the used nodes (marked with the current traversal ID) on the given words of the truth tables
+// and marks the outputs that differ from the specification (independently of the truth tables stored in the graph)
+// (the outputs before iFirst are not checked, and the specification holds the truth tables of the following ones)
+static void kc_gg_sim_words(kc_gg *gg, const int *pWords, int nWords, int iFirst, std::vector<kc_uint64> &Sims, std::vector<char> &Failed)
+{
+    int i, v, w, top;
+    Sims.resize((size_t)gg->size * nWords);
+    for (w = 0; w < nWords; w++)
+        Sims[w] = 0;
+    for (i = 0; i < gg->nins; i++)
+        for (w = 0; w < nWords; w++)
+            Sims[(size_t)(1 + i) * nWords + w] = i < 6 ? s_Truths6[i] : ((pWords[w] >> (i - 6)) & 1) ? ~(kc_uint64)0 : 0;
+    for (v = 1 + gg->nins; v < gg->size; v++)
+        if (kc_gg_tid_is_cur(gg, v))
+        {
+            int lit0 = kc_gg_fanin(gg, v, 0), lit1 = kc_gg_fanin(gg, v, 1);
+            kc_uint64 *pS = &Sims[(size_t)v * nWords];
+            kc_uint64 *pS0 = &Sims[(size_t)kc_l2v(lit0) * nWords], m0 = kc_l2c(lit0) ? ~(kc_uint64)0 : 0;
+            kc_uint64 *pS1 = &Sims[(size_t)kc_l2v(lit1) * nWords], m1 = kc_l2c(lit1) ? ~(kc_uint64)0 : 0;
+            if (kc_gg_is_xor(gg, v))
+                for (w = 0; w < nWords; w++)
+                    pS[w] = pS0[w] ^ m0 ^ pS1[w] ^ m1;
+            else
+                for (w = 0; w < nWords; w++)
+                    pS[w] = (pS0[w] ^ m0) & (pS1[w] ^ m1);
+        }
+    for (i = iFirst; i < kc_vi_size(&gg->tops); i++)
+    {
+        top = kc_vi_read(&gg->tops, i);
+        kc_uint64 *pS = &Sims[(size_t)kc_l2v(top) * nWords], m = kc_l2c(top) ? ~(kc_uint64)0 : 0;
+        kc_uint64 *pOut = kc_vt_read(&gg->outs, i - iFirst);
+        for (w = 0; w < nWords && !Failed[i - iFirst]; w++)
+            Failed[i - iFirst] = (pS[w] ^ m) != pOut[pWords[w]];
+    }
+}
+// simulates the chunks of words assigned to one thread
+static void kc_gg_sim_thread(kc_gg *gg, int iThread, int nThreads, int iFirst, std::vector<char> *pFailed)
+{
+    std::vector<kc_uint64> Sims;
+    int w, pWords[KC_SIM_CHUNK], words = gg->outs.words;
+    for (int Start = iThread * KC_SIM_CHUNK; Start < words; Start += nThreads * KC_SIM_CHUNK)
+    {
+        int nWords = kc_min(KC_SIM_CHUNK, words - Start);
+        for (w = 0; w < nWords; w++)
+            pWords[w] = Start + w;
+        kc_gg_sim_words(gg, pWords, nWords, iFirst, Sims, *pFailed);
+    }
+}
+// verifies the graph by simulating it in one topological pass, either exhaustively (nRandom = 0), with the words
+// split among the threads, or on the given number of randomly chosen words; returns the number of failed outputs
+// (only the outputs starting from iFirst are verified, for example, those of the last chunk)
+int kc_gg_verify_sim(kc_gg *gg, int nThreads, int nRandom, int iFirst)
+{
+    int i, k, nFailed = 0, words = gg->outs.words;
+    std::vector<char> Failed(kc_gg_po_num(gg) - iFirst, 0);
+    kc_gg_tid_increment(gg); // mark the nodes used by the verified outputs
+    for (i = iFirst; i < kc_vi_size(&gg->tops); i++)
+        kc_gg_node_count_iter(gg, kc_vi_read(&gg->tops, i));
+    if (nRandom > 0 && nRandom < words)
+    {
+        std::vector<kc_uint64> Sims;
+        kc_uint64 State = 0x9E3779B97F4A7C15;
+        int pWords[KC_SIM_CHUNK];
+        for (i = 0; i < nRandom; i += KC_SIM_CHUNK)
+        {
+            int nWords = kc_min(KC_SIM_CHUNK, nRandom - i);
+            for (k = 0; k < nWords; k++)
+                pWords[k] = (int)(kc_random64(&State) % words);
+            kc_gg_sim_words(gg, pWords, nWords, iFirst, Sims, Failed);
+        }
+    }
+    else
+    {
+        nThreads = kc_max(1, kc_min(nThreads, (words + KC_SIM_CHUNK - 1) / KC_SIM_CHUNK));
+        std::vector<std::vector<char> > Fails(nThreads, Failed);
+        std::vector<std::thread> Threads;
+        for (i = 1; i < nThreads; i++)
+            Threads.push_back(std::thread(kc_gg_sim_thread, gg, i, nThreads, iFirst, &Fails[i]));
+        kc_gg_sim_thread(gg, 0, nThreads, iFirst, &Fails[0]);
+        for (i = 1; i < nThreads; i++)
+            Threads[i - 1].join();
+        for (i = 0; i < nThreads; i++)
+            for (k = 0; k < (int)Failed.size(); k++)
+                Failed[k] |= Fails[i][k];
+    }
+    for (k = 0; k < (int)Failed.size(); k++)
+        nFailed += Failed[k];
+    return nFailed;
+}
+
+/*************************************************************
+                   Symmetry detection
+**************************************************************/
+
+// checks whether all functions are symmetric (fSkew = 0) or skew-symmetric (fSkew = 1) in the two variables
+static inline int kc_vt_is_symm(kc_vt *v, int iVar, int jVar, int fSkew)
+{
+    int t, nTts = v->size, Res = 1;
+    for (t = 0; Res && t < nTts; t++)
+    {
+        int c0 = kc_vt_cof0(v, t, jVar);
+        int c1 = kc_vt_cof1(v, t, jVar);
+        int a = fSkew ? kc_vt_cof0(v, c0, iVar) : kc_vt_cof1(v, c0, iVar);
+        int b = fSkew ? kc_vt_cof1(v, c1, iVar) : kc_vt_cof0(v, c1, iVar);
+        Res = kc_vt_is_equal(v, a, b);
+        kc_vt_shrink(v, 4);
+    }
+    return Res;
+}
+// groups the variables into classes of symmetric variables (pClass[v] is the smallest variable in the class of v);
+// if fPhase is set, the variable skew-symmetric with a class is complemented in all functions and added to the class
+static inline int kc_sym_classes(kc_vt *outs, int nvars, int fPhase, int *pClass, unsigned *pPhase)
+{
+    int i, j, t, nClasses = 0;
+    *pPhase = 0;
+    for (j = 0; j < nvars; j++)
+    {
+        pClass[j] = j;
+        for (i = 0; i < j; i++)
+        {
+            if (pClass[i] != i)
+                continue;
+            if (kc_vt_is_symm(outs, i, j, 0))
+            {
+                pClass[j] = i;
+                break;
+            }
+            if (fPhase && kc_vt_is_symm(outs, i, j, 1))
+            {
+                for (t = 0; t < outs->size; t++)
+                    kc_vt_flip_var(outs, t, j);
+                *pPhase |= 1 << j;
+                pClass[j] = i;
+                break;
+            }
+        }
+        nClasses += pClass[j] == j;
+    }
+    return nClasses;
+}
+// the number of minterms in which the functions depend on the variable (summed over all functions)
+static inline long long kc_vt_influence(kc_vt *v, int iVar)
+{
+    int t, nTts = v->size;
+    long long Res = 0;
+    for (t = 0; t < nTts; t++)
+    {
+        int c0 = kc_vt_cof0(v, t, iVar);
+        int c1 = kc_vt_cof1(v, t, iVar);
+        Res += kc_vt_count_ones(v, kc_vt_xor(v, c0, c1));
+        kc_vt_shrink(v, 3);
+    }
+    return Res;
+}
+// the number of distinct variable orders when the variables of the same class are not distinguished
+static inline long long kc_sym_order_num(int *pClass, int nvars)
+{
+    long long Res = 1;
+    int i, Count[MAX_VARS] = {0};
+    for (i = 0; i < nvars; i++)
+        Res = Res * (i + 1) / ++Count[pClass[i]];
+    return Res;
+}
+
+/*************************************************************
+           Estimating the cost of variable orders
+**************************************************************/
+
+#define KC_EST_MAX_VARS 12 // the largest number of inputs for ranking variable orders by the estimated cost
+
+// adds the last truth table to the distinct functions unless it is already there (up to complementation)
+// and returns the truth table of the function
+static inline int kc_est_add(kc_vt *v, std::unordered_map<kc_uint64, int> &hash, std::vector<int> &funcs)
+{
+    int i, ttId = v->size - 1;
+    kc_uint64 *pA = kc_vt_read(v, ttId);
+    if (pA[0] & 1)
+        for (i = 0; i < v->words; i++)
+            pA[i] = ~pA[i];
+    for (kc_uint64 Key = kc_vt_hash(v, ttId);; Key++)
+    {
+        std::unordered_map<kc_uint64, int>::iterator it = hash.find(Key);
+        if (it == hash.end())
+        {
+            hash[Key] = ttId;
+            funcs.push_back(ttId);
+            return ttId;
+        }
+        if (kc_vt_is_equal(v, it->second, ttId))
+        {
+            kc_vt_shrink(v, 1);
+            return it->second;
+        }
+    }
+}
+// computes the number of distinct cofactors (up to complementation) w.r.t. each subset S of variables
+// depending on each variable v outside of S; pCost[S * nvars + v] is the width of the shared BDD
+// with complemented edges at the level of v when the variables of S are above it
+// (if fXor is set, the XORs of the two cofactors used by Davio expansions are counted as well)
+// the cofactors w.r.t. the subsets of size k are kept as the functions of the remaining nvars-k variables,
+// so the truth tables shrink by half at each layer; the positions of the variables in them are kept for each subset
+static inline int *kc_est_start(kc_vt *outs, int nvars, int fXor)
+{
+    int i, k, t, u, v, S, nSets = 1 << nvars;
+    int *pCost = (int *)calloc((size_t)nSets * nvars, sizeof(int));
+    std::vector<std::vector<int>> Funcs(nSets);
+    std::vector<signed char> Pos((size_t)nSets * nvars, -1); // the position of each variable in the truth tables
+    std::unordered_map<kc_uint64, int> Hash;
+    kc_vt Store[2], *store = &Store[0], *next = &Store[1];
+    kc_vt_start(store, 4 * outs->size + 4, outs->words);
+    for (t = 0; t < outs->size; t++)
+    {
+        kc_vt_move(store, outs, t);
+        kc_est_add(store, Hash, Funcs[0]);
+    }
+    for (v = 0; v < nvars; v++)
+        Pos[v] = v;
+    for (k = 0; k < nvars; k++)
+    {
+        // count the nodes below the subsets of size k
+        for (S = 0; S < nSets; S++)
+            if ((int)Funcs[S].size() > 0)
+                for (v = 0; v < nvars; v++)
+                    if (!((S >> v) & 1))
+                        for (i = 0; i < (int)Funcs[S].size(); i++)
+                            pCost[S * nvars + v] += kc_vt_has_var(store, Funcs[S][i], Pos[S * nvars + v]);
+        if (k == nvars - 1)
+            break;
+        // derive the cofactors of the subsets of size k+1 from those of size k
+        int m = nvars - 1 - k; // the top position in the truth tables of size k
+        kc_vt_start(next, 4 * (int)Funcs[0].size() + 4, kc_truth_word_num(m));
+        for (S = 0; S < nSets; S++)
+        {
+            int nBits = 0;
+            for (u = 0; u < nvars; u++)
+                nBits += (S >> u) & 1;
+            if (nBits != k + 1)
+                continue;
+            for (u = nvars - 1; !((S >> u) & 1); u--)
+                ;
+            // the variable at the top position moves into the position of u, which is cofactored
+            int P = S ^ (1 << u), p = Pos[P * nvars + u];
+            for (v = 0; v < nvars; v++)
+                Pos[S * nvars + v] = Pos[P * nvars + v] == m ? p : Pos[P * nvars + v];
+            Pos[S * nvars + u] = -1;
+            std::vector<int> &Prev = Funcs[P];
+            Hash.clear();
+            for (i = 0; i < (int)Prev.size(); i++)
+            {
+                int tmp = store->size;
+                kc_vt_move(store, store, Prev[i]);
+                kc_vt_swap_vars(store, tmp, p, m);
+                memcpy(kc_vt_append(next), kc_vt_read(store, kc_vt_cof0(store, tmp, m)), 8 * next->words);
+                int f0 = kc_est_add(next, Hash, Funcs[S]);
+                memcpy(kc_vt_append(next), kc_vt_read(store, kc_vt_cof1(store, tmp, m)), 8 * next->words);
+                int f1 = kc_est_add(next, Hash, Funcs[S]);
+                kc_vt_shrink(store, 3);
+                if (fXor && f0 != f1)
+                {
+                    kc_vt_xor(next, f0, f1);
+                    kc_est_add(next, Hash, Funcs[S]);
+                }
+            }
+        }
+        // keep only the truth tables of the new subsets
+        for (S = 0; S < nSets; S++)
+        {
+            int nBits = 0;
+            for (u = 0; u < nvars; u++)
+                nBits += (S >> u) & 1;
+            if (nBits == k)
+                Funcs[S].clear();
+        }
+        kc_vt_stop(store);
+        KC_SWAP(kc_vt *, store, next)
+    }
+    kc_vt_stop(store);
+    return pCost;
+}
+// the estimated cost of the order (pVars[k] is the variable at position k; the top variable is the last one)
+static inline int kc_est_order(int *pCost, int *pVars, int nvars)
+{
+    int k, S = 0, Res = 0;
+    for (k = nvars - 1; k >= 0; k--)
+    {
+        Res += pCost[S * nvars + pVars[k]];
+        S |= 1 << pVars[k];
+    }
+    return Res;
+}
+
+// finds the order with the smallest estimated cost by dynamic programming over the subsets of variables placed
+// above the others (as proposed by Friedman and Supowit for BDDs) instead of enumerating the orders;
+// pVars receives the order as in kc_est_order(); returns its cost
+static inline int kc_est_best(int *pCost, int nvars, int *pVars)
+{
+    int k, v, S, nSets = 1 << nvars;
+    std::vector<int> Best(nSets, 0x7FFFFFFF), Last(nSets, -1); // the cost of the subset and its lowest variable
+    Best[0] = 0;
+    for (S = 0; S < nSets; S++) // the subsets are visited before their supersets
+        for (v = 0; v < nvars; v++)
+            if (!((S >> v) & 1) && Best[S | (1 << v)] > Best[S] + pCost[S * nvars + v])
+                Best[S | (1 << v)] = Best[S] + pCost[S * nvars + v], Last[S | (1 << v)] = v;
+    for (S = nSets - 1, k = 0; k < nvars; k++)
+        pVars[k] = v = Last[S], S ^= 1 << v;
+    assert(kc_est_order(pCost, pVars, nvars) == Best[nSets - 1]);
+    return Best[nSets - 1];
+}
+
+/*************************************************************
+             Library of 4-input structures
+**************************************************************/
+
+int synthesis_and_rec(kc_gg *gg, int ttId, int varId);
+int synthesis_xor_rec(kc_gg *gg, int ttId, int varId);
+
+#define KC_LIB_VARS 4 // the number of the bottom variables whose functions are taken from the library
+
+// the structures of 4-input functions (AIGs and XAIGs): the output literal followed by the fanins of the nodes
+// (literal 2*(1+i) is leaf i, literal 2*(5+k) is node k, which is an xor-gate if its first fanin is larger)
+static std::unordered_map<unsigned, std::vector<int>> s_RwLib[2];
+
+// returns the smallest AIG (or XAIG) of the 4-input function found by the recursive synthesis over all variable orders
+static inline std::vector<int> &kc_rw_structure(unsigned uTruth, int fXor)
+{
+    std::unordered_map<unsigned, std::vector<int>>::iterator it = s_RwLib[fXor].find(uTruth);
+    if (it != s_RwLib[fXor].end())
+        return it->second;
+    std::vector<int> &Best = s_RwLib[fXor][uTruth];
+    int a, i, k, Perm[4], nBest = 0x7FFFFFFF;
+    for (a = 0; a < 2; a++)
+    {
+        kc_vt Outs, *outs = &Outs;
+        kc_vt_start(outs, 1, 1);
+        *kc_vt_append(outs) = kc_truth_stretch(uTruth, 4);
+        for (i = 0; i < 4; i++)
+            Perm[i] = i;
+        for (k = 0; k < 24; k++)
+        {
+            kc_gg *gg = kc_gg_start(4, outs);
+            kc_vt_move(&gg->funcs, &gg->outs, 0);
+            kc_vi_push(&gg->tops, a ? synthesis_and_rec(gg, 0, 3) : synthesis_xor_rec(gg, 0, 3));
+            memcpy(gg->perm, Perm, sizeof(int) * 4);
+            kc_gg_node_count(gg);
+            kc_gg *ggNew = kc_gg_dup(gg, !fXor);
+            if (nBest > kc_gg_node_num(ggNew))
+            {
+                nBest = kc_gg_node_num(ggNew);
+                Best.assign(1, kc_vi_read(&ggNew->tops, 0));
+                Best.insert(Best.end(), kc_vi_array(&ggNew->fans) + 2 * 5, kc_vi_array(&ggNew->fans) + 2 * ggNew->size);
+            }
+            kc_gg_stop(ggNew);
+            kc_gg_stop(gg);
+            kc_get_next_perm(Perm, 4, outs);
+        }
+        kc_vt_stop(outs);
+    }
+    return Best;
+}
+
+// creates the structure in the new graph on top of the given leaf literals
+static inline int kc_rw_build_structure(kc_gg *ggNew, std::vector<int> &Str, int *pLeaves)
+{
+    int k, Lits[2 * (5 + 64)];
+    Lits[0] = 0, Lits[1] = 1;
+    for (k = 0; k < 4; k++)
+        Lits[2 * (1 + k)] = pLeaves[k], Lits[2 * (1 + k) + 1] = kc_lnot(pLeaves[k]);
+    assert((int)Str.size() / 2 <= 64);
+    for (k = 0; 2 * k + 1 < (int)Str.size(); k++)
+    {
+        if (Str[1 + 2 * k] > Str[2 + 2 * k])
+            Lits[2 * (5 + k)] = kc_gg_xor(ggNew, Lits[Str[1 + 2 * k]], Lits[Str[2 + 2 * k]]);
+        else
+            Lits[2 * (5 + k)] = kc_gg_and(ggNew, Lits[Str[1 + 2 * k]], Lits[Str[2 + 2 * k]]);
+        Lits[2 * (5 + k) + 1] = kc_lnot(Lits[2 * (5 + k)]);
+    }
+    return Lits[Str[0]];
+}
+
+// the NPN classes of the 4-input functions: the entry of each function gives its class representative
+// (bits 16-31) and the transformation producing the function from it: the input literal feeding each leaf
+// of the representative (bits 3k-3k+2 hold the variable and its complement for leaf k) and the output
+// complement (bit 12); the classes are found by closing each representative under the swaps of adjacent
+// variables, complementation of each variable, and complementation of the output
+static inline std::vector<unsigned> kc_npn4_compute()
+{
+    std::vector<unsigned> Table(1 << 16, 0xFFFFFFFF);
+    std::vector<unsigned> Queue;
+    unsigned uRep, uTruth, Entry;
+    int i, k, h;
+    for (uRep = 0; uRep < (1u << 16); uRep++)
+    {
+        if (Table[uRep] != 0xFFFFFFFF) // all smaller functions are classified, so the representative is the smallest
+            continue;
+        Table[uRep] = (uRep << 16) | (3 << 9) | (2 << 6) | (1 << 3);
+        Queue.assign(1, uRep);
+        for (h = 0; h < (int)Queue.size(); h++)
+        {
+            kc_uint64 t = kc_truth_stretch(Queue[h], 4);
+            Entry = Table[Queue[h]];
+            for (i = 0; i < 9; i++)
+            {
+                unsigned EntryNew = Entry;
+                if (i < 3) // swap variables i and i+1
+                {
+                    kc_uint64 *s_PMasks = s_PPMasks[i][i + 1];
+                    uTruth = (unsigned)(((t & s_PMasks[0]) | ((t & s_PMasks[1]) << (1 << i)) | ((t & s_PMasks[2]) >> (1 << i))) & 0xFFFF);
+                    for (k = 0; k < 4; k++)
+                        if ((int)((Entry >> 3 * k) & 3) == i || (int)((Entry >> 3 * k) & 3) == i + 1)
+                            EntryNew ^= (unsigned)(i ^ (i + 1)) << 3 * k;
+                }
+                else if (i < 7) // complement variable i-3
+                {
+                    uTruth = (unsigned)((((t & s_Truths6[i - 3]) >> (1 << (i - 3))) | ((t & s_Truths6Neg[i - 3]) << (1 << (i - 3)))) & 0xFFFF);
+                    for (k = 0; k < 4; k++)
+                        if ((int)((Entry >> 3 * k) & 3) == i - 3)
+                            EntryNew ^= 4 << 3 * k;
+                }
+                else // complement the output
+                    uTruth = (unsigned)(~t & 0xFFFF), EntryNew ^= 1 << 12;
+                if (Table[uTruth] != 0xFFFFFFFF)
+                    continue;
+                Table[uTruth] = EntryNew;
+                Queue.push_back(uTruth);
+            }
+        }
+    }
+    return Table;
+}
+static inline const std::vector<unsigned> &kc_npn4_table()
+{
+    static const std::vector<unsigned> Table = kc_npn4_compute(); // computed once at the first use
+    return Table;
+}
+// computes the structures of all NPN classes in advance, so that the threads only look them up
+static inline void kc_lib_prepare()
+{
+    const std::vector<unsigned> &Table = kc_npn4_table();
+    for (size_t i = 0; i < Table.size(); i++)
+        if ((Table[i] >> 16) == i)
+            kc_rw_structure(Table[i] >> 16, 0), kc_rw_structure(Table[i] >> 16, 1);
+}
+
+// builds the function of the bottom variables using the library structure of its NPN class
+static inline int kc_lib_build(kc_gg *gg, unsigned Entry, std::vector<int> &Str)
+{
+    KC_PROF_COUNT(KC_PROF_LIB);
+    int k, Leaves[4];
+    for (k = 0; k < 4; k++)
+    {
+        int Var = (Entry >> 3 * k) & 3, Compl = (Entry >> (3 * k + 2)) & 1;
+        Leaves[k] = Var < gg->nins ? kc_v2l(1 + Var, Compl) : 0; // the missing inputs are not used
+    }
+    return kc_lnotc(kc_rw_build_structure(gg, Str, Leaves), (Entry >> 12) & 1);
+}
+// builds the function of the bottom variables by the recursion and, unless the library structure is larger,
+// also from the library; returns the smaller circuit (the recursion shares more nodes with the rest of the graph,
+// while the structure is the best one for the function alone, so neither of them is always better);
+// the circuits of the same size are compared by the and-nodes after expanding the xor-gates
+static inline int kc_lib_choose(kc_gg *gg, int ttId, int varId, int fXor)
+{
+    gg->lib = 0;
+    int litRec = fXor ? synthesis_xor_rec(gg, ttId, varId) : synthesis_and_rec(gg, ttId, varId);
+    gg->lib = 1;
+    int nRec, nLib, nAndsRec = kc_gg_and_count1(gg, litRec, &nRec);
+    unsigned Entry = kc_npn4_table()[kc_vt_read(&gg->funcs, ttId)[0] & 0xFFFF];
+    std::vector<int> &Str = kc_rw_structure(Entry >> 16, fXor);
+    if ((int)Str.size() / 2 > nRec)
+        return litRec;
+    int litLib = kc_lib_build(gg, Entry, Str);
+    int nAndsLib = kc_gg_and_count1(gg, litLib, &nLib);
+    return nLib < nRec || (nLib == nRec && nAndsLib <= nAndsRec) ? litLib : litRec;
+}
+
+/*************************************************************
+                  Recursive synthesis
+**************************************************************/
+
+// takes the function and the top-most variable; returns literal of the circuit
+int synthesis_and_rec(kc_gg *gg, int ttId, int varId)
+{
+    int iLit;
+    KC_PROF_COUNT(KC_PROF_REC_AND);
+    if (gg->cancel && *gg->cancel) // unwind quickly
+        return 0;
+    if ((iLit = kc_gg_hash_function(gg, ttId, kc_truth_word_num(varId + 1))) >= 0)
+        return iLit;
+    if (gg->lib && varId < KC_LIB_VARS)
+        return kc_lib_choose(gg, ttId, varId, 0);
+    // if ( kc_vt_is_const0(&gg->funcs, ttId) ) return 0;
+    // if ( kc_vt_is_const1(&gg->funcs, ttId) ) return 1;
+    if (!kc_vt_has_var_top(&gg->funcs, ttId, varId))
+        return synthesis_and_rec(gg, ttId, varId - 1);
+    int f0 = kc_vt_cof0_top(&gg->funcs, ttId, varId);
+    int f1 = kc_vt_cof1_top(&gg->funcs, ttId, varId);
+    int lit0 = synthesis_and_rec(gg, f0, varId - 1);
+    int lit1 = synthesis_and_rec(gg, f1, varId - 1);
+    kc_vt_shrink(&gg->funcs, 2);
+    return kc_gg_mux(gg, kc_v2l(1 + varId, 0), lit1, lit0);
+}
+int synthesis_xor_rec(kc_gg *gg, int ttId, int varId)
+{
+    int iLit;
+    KC_PROF_COUNT(KC_PROF_REC_XOR);
+    if (gg->cancel && *gg->cancel) // unwind quickly
+        return 0;
+    if ((iLit = kc_gg_hash_function(gg, ttId, kc_truth_word_num(varId + 1))) >= 0)
+        return iLit;
+    if (gg->lib && varId < KC_LIB_VARS)
+        return kc_lib_choose(gg, ttId, varId, 1);
+    // if ( kc_vt_is_const0(&gg->funcs, ttId) ) return 0;
+    // if ( kc_vt_is_const1(&gg->funcs, ttId) ) return 1;
+    if (!kc_vt_has_var_top(&gg->funcs, ttId, varId))
+        return synthesis_xor_rec(gg, ttId, varId - 1);
+    int f0 = kc_vt_cof0_top(&gg->funcs, ttId, varId);
+    int f1 = kc_vt_cof1_top(&gg->funcs, ttId, varId);
+    int f2 = kc_vt_xor_words(&gg->funcs, f0, f1, kc_truth_word_num(varId));
+    int lit0 = synthesis_xor_rec(gg, f0, varId - 1);
+    int lit1 = synthesis_xor_rec(gg, f1, varId - 1);
+    int lit2 = synthesis_xor_rec(gg, f2, varId - 1);
+    kc_vt_shrink(&gg->funcs, 3);
+    int n01 = kc_gg_node_count2(gg, lit0, lit1) + 1 + 2 * (lit0 >= 2 && lit1 >= 2);
+    int n02 = kc_gg_node_count2(gg, lit0, lit2) + 1 + 1 * (lit0 >= 2 && lit1 >= 2);
+    int n12 = kc_gg_node_count2(gg, lit1, lit2) + 1 + 1 * (lit0 >= 2 && lit1 >= 2);
+    long long c01 = n01, c02 = n02, c12 = n12;
+    if (gg->delay) // compare the levels of the results first
+    {
+        int l0 = kc_gg_lit_level(gg, lit0), l1 = kc_gg_lit_level(gg, lit1), lx = kc_level_gate(0, kc_gg_lit_level(gg, lit2));
+        c01 = kc_gg_cost(gg, kc_level_gate(kc_level_gate(0, l1), kc_level_gate(0, l0)), n01);
+        c02 = kc_gg_cost(gg, kc_level_gate(lx, l0), n02);
+        c12 = kc_gg_cost(gg, kc_level_gate(lx, l1), n12);
+    }
+    long long min = c01 < c02 ? c01 : c02;
+    if (min > c12)
+        min = c12;
+    if (min == c01) // Shannon
+        return kc_gg_mux(gg, kc_v2l(1 + varId, 0), lit1, lit0);
+    if (min == c02) // positive Davio
+        return kc_gg_and_xor(gg, kc_v2l(1 + varId, 0), lit2, lit0);
+    if (min == c12) // negative Davio
+        return kc_gg_and_xor(gg, kc_v2l(1 + varId, 1), lit2, lit1);
+    return -1;
+}
+
+/*************************************************************
+             Fixed-polarity Reed-Muller forms
+**************************************************************/
+
+// the butterfly transforming the Reed-Muller spectrum w.r.t. one variable in place:
+// fPos = 1 computes the positive Davio expansion of the truth table (f1 ^= f0), while fPos = 0
+// switches the polarity of the variable in the spectrum (f0 ^= f1), which is its own inverse
+static inline void kc_vt_rm_var(kc_vt *v, int ttId, int iVar, int fPos)
+{
+    kc_uint64 *tt = kc_vt_read(v, ttId);
+    int w, i;
+    if (iVar < 6)
+    {
+        int Shift = 1 << iVar;
+        for (w = 0; w < v->words; w++)
+            tt[w] ^= fPos ? (tt[w] & s_Truths6Neg[iVar]) << Shift : (tt[w] & s_Truths6[iVar]) >> Shift;
+        return;
+    }
+    int Step = kc_truth_word_num(iVar);
+    for (w = 0; w < v->words; w += 2 * Step)
+        for (i = 0; i < Step; i++)
+            if (fPos)
+                tt[w + Step + i] ^= tt[w + i];
+            else
+                tt[w + i] ^= tt[w + Step + i];
+}
+// the number of product terms of the spectrum (the truth tables of less than 6 variables are stretched)
+static inline int kc_rm_term_num(kc_vt *spec, int nvars)
+{
+    int i, Res = 0;
+    for (i = 0; i < spec->size; i++)
+        Res += kc_vt_count_ones(spec, i);
+    return nvars < 6 ? Res >> (6 - nvars) : Res;
+}
+// computes the spectra of the outputs for the polarity (the bits of the variables used complemented)
+static inline void kc_rm_spectra(kc_vt *outs, int nvars, unsigned Polarity, kc_vt *spec)
+{
+    int i, k;
+    kc_vt_dup(spec, outs);
+    for (i = 0; i < spec->size; i++)
+        for (k = 0; k < nvars; k++)
+        {
+            kc_vt_rm_var(spec, i, k, 1);
+            if ((Polarity >> k) & 1)
+                kc_vt_rm_var(spec, i, k, 0);
+        }
+}
+// finds the polarity of the variables minimizing the number of product terms of the fixed-polarity
+// Reed-Muller forms of all outputs by visiting the polarities in the Gray-code order, so that each
+// step switches one variable in the spectra; returns the number of terms and sets the polarity
+static inline int kc_rm_best_polarity(kc_vt *outs, int nvars, unsigned *pPolarity)
+{
+    kc_vt Spec, *spec = &Spec;
+    unsigned k, Polarity = 0;
+    int i, v, Terms, TermsBest;
+    kc_rm_spectra(outs, nvars, 0, spec);
+    TermsBest = kc_rm_term_num(spec, nvars), *pPolarity = 0;
+    for (k = 1; k < (1u << nvars); k++)
+    {
+        for (v = 0; !((k >> v) & 1); v++)
+            ;
+        Polarity ^= 1 << v;
+        for (i = 0; i < spec->size; i++)
+            kc_vt_rm_var(spec, i, v, 0);
+        if ((Terms = kc_rm_term_num(spec, nvars)) < TermsBest)
+            TermsBest = Terms, *pPolarity = Polarity;
+    }
+    kc_vt_stop(spec);
+    return TermsBest;
+}
+// the number of nodes of the circuit of the forms (the products share their prefixes ordered by variables)
+static inline int kc_rm_node_num(kc_vt *outs, int nvars, unsigned Polarity)
+{
+    kc_vt Spec, *spec = &Spec;
+    std::vector<char> Used(1 << nvars, 0);
+    int i, m, Res = 0;
+    kc_rm_spectra(outs, nvars, Polarity, spec);
+    for (i = 0; i < spec->size; i++)
+    {
+        int nTerms = 0;
+        kc_uint64 *tt = kc_vt_read(spec, i);
+        for (m = 0; m < (1 << nvars); m++)
+            if ((tt[m >> 6] >> (m & 63)) & 1)
+            {
+                nTerms += m > 0; // the constant term complements the output
+                for (int p = m; (p & (p - 1)) && !Used[p]; p &= p - 1) // the products of two or more literals
+                    Used[p] = 1, Res++;
+            }
+        Res += kc_max(nTerms - 1, 0);
+    }
+    kc_vt_stop(spec);
+    return Res;
+}
+// builds the product of the literals of the term (memoized by the term)
+static inline int kc_rm_product(kc_gg *gg, int m, unsigned Polarity, std::vector<int> &Prods)
+{
+    if (m == 0)
+        return 1;
+    if (Prods[m] >= 0)
+        return Prods[m];
+    int v = 0;
+    while (!((m >> v) & 1))
+        v++;
+    return Prods[m] = kc_gg_and(gg, kc_rm_product(gg, m & (m - 1), Polarity, Prods), kc_v2l(1 + v, (Polarity >> v) & 1));
+}
+// builds the circuit of the fixed-polarity Reed-Muller forms of the outputs
+static inline kc_gg *kc_rm_build(kc_vt *outs, int nvars, unsigned Polarity)
+{
+    kc_vt Spec, *spec = &Spec;
+    std::vector<int> Prods(1 << nvars, -1);
+    kc_gg *gg = kc_gg_start(nvars, outs);
+    kc_rm_spectra(outs, nvars, Polarity, spec);
+    for (int i = 0; i < spec->size; i++)
+    {
+        kc_uint64 *tt = kc_vt_read(spec, i);
+        int m, top = 0;
+        for (m = 0; m < (1 << nvars); m++)
+            if ((tt[m >> 6] >> (m & 63)) & 1)
+                top = kc_gg_xor(gg, top, kc_rm_product(gg, m, Polarity, Prods));
+        kc_vi_push(&gg->tops, top);
+    }
+    kc_vt_stop(spec);
+    return gg;
+}
+
+/*************************************************************
+                  Reading input data
+**************************************************************/
+
+static inline int kc_log2(unsigned n)
+{
+    int r;
+    if (n < 2)
+        return (int)n;
+    for (r = 0, n--; n; n >>= 1, r++)
+    {
+    };
+    return r;
+}
+static inline int kc_hex_to_int(char c)
+{
+    int Digit = 0;
+    if (c >= '0' && c <= '9')
+        Digit = c - '0';
+    else if (c >= 'A' && c <= 'F')
+        Digit = c - 'A' + 10;
+    else if (c >= 'a' && c <= 'f')
+        Digit = c - 'a' + 10;
+    else
+        assert(0);
+    assert(Digit >= 0 && Digit < 16);
+    return Digit;
+}
+
+// appends the truth table given in hex notation (nChars hex digits of nVars-input function)
+static inline void kc_read_hex(const char *pInput, int nChars, int nVars, kc_vt *outs)
+{
+    kc_uint64 *tt = kc_vt_append(outs), Num = 0;
+    int i;
+    assert(4 * nChars == (1 << nVars) && outs->words == kc_truth_word_num(nVars));
+    memset(tt, 0, 8 * outs->words);
+    for (i = nChars - 1; i >= 0; i--)
+    {
+        Num |= (kc_uint64)kc_hex_to_int(pInput[nChars - 1 - i]) << ((i & 0xF) * 4);
+        if ((i & 0xF) == 0)
+            tt[i >> 4] = Num, Num = 0;
+    }
+    if (nVars < 6)
+        tt[0] = kc_truth_stretch(tt[0], nVars);
+}
+static inline int kc_read_line(kc_vt *outs, kc_vi *chars, int nVars)
+{
+    int i, entry;
+    assert(chars->size > 0);
+    if (nVars == 0)
+    {
+        nVars = kc_log2(chars->size);
+        kc_vt_start(outs, 0, kc_truth_word_num(nVars));
+    }
+    assert(nVars == kc_log2(chars->size));
+    if ((1 << nVars) != chars->size)
+    {
+        printf("The input string length (%d chars) does not match the size (%d bits) of the truth table of %d-var function.\n",
+               chars->size, 1 << nVars, nVars);
+        kc_vt_stop(outs);
+        kc_vi_stop(chars);
+        return 0;
+    }
+    kc_uint64 *tt = kc_vt_append(outs);
+    memset(tt, 0, 8 * outs->words);
+    kc_vi_for_each_entry(chars, entry, i) if (entry == (int)'1')
+        tt[(chars->size - 1 - i) >> 6] |= ((kc_uint64)1) << ((chars->size - 1 - i) & 63);
+    if (nVars < 6)
+        tt[0] = kc_truth_stretch(tt[0], nVars);
+    kc_vi_resize(chars, 0);
+    return nVars;
+}
+static inline int kc_read_file(FILE *pFile, kc_vt *outs)
+{
+    kc_vi Chars, *chars = &Chars;
+    kc_vi_start(chars, 1000);
+    int c, nVars = 0;
+    while ((c = fgetc(pFile)) != EOF)
+    {
+        if (c == '\r' || c == '\t' || c == ' ')
+            continue;
+        if (c != '\n')
+            kc_vi_push(chars, c);
+        else if (chars->size && (nVars = kc_read_line(outs, chars, nVars)) == 0)
+            return 0;
+    }
+    if (chars->size && (nVars = kc_read_line(outs, chars, nVars)) == 0)
+        return 0;
+    kc_vi_stop(chars);
+    return nVars;
+}
+// reads one line of text; joins lines ending in '\' and drops comments starting with '#'
+static inline int kc_read_text_line(FILE *pFile, std::string &line)
+{
+    int c, fComment = 0;
+    line.clear();
+    while ((c = fgetc(pFile)) != EOF)
+    {
+        if (c == '\r')
+            continue;
+        if (c == '#')
+            fComment = 1;
+        if (c == '\n')
+        {
+            if (!fComment && !line.empty() && line[line.size() - 1] == '\\')
+            {
+                line[line.size() - 1] = ' ';
+                continue;
+            }
+            return 1;
+        }
+        if (!fComment)
+            line.push_back(c == '\t' ? ' ' : (char)c);
+    }
+    return !line.empty();
+}
+// splits the line into space-separated tokens
+static inline void kc_split_line(std::string &line, std::vector<std::string> &tokens)
+{
+    size_t i = 0, k;
+    tokens.clear();
+    while (i < line.size())
+    {
+        while (i < line.size() && line[i] == ' ')
+            i++;
+        for (k = i; k < line.size() && line[k] != ' '; k++)
+            ;
+        if (k > i)
+            tokens.push_back(line.substr(i, k - i));
+        i = k;
+    }
+}
+// returns the given word of the truth table of the elementary variable
+static inline kc_uint64 kc_truth_var_word(int iVar, int w)
+{
+    if (iVar < 6)
+        return s_Truths6[iVar];
+    return ((w >> (iVar - 6)) & 1) ? ~(kc_uint64)0 : 0;
+}
+// computes the given word of the cube (care and vals are bit-masks over the inputs)
+static inline kc_uint64 kc_truth_cube_word(unsigned care, unsigned vals, int nVars, int w)
+{
+    kc_uint64 Res = ~(kc_uint64)0;
+    int v;
+    for (v = 0; v < nVars; v++)
+        if ((care >> v) & 1)
+            Res &= ((vals >> v) & 1) ? kc_truth_var_word(v, w) : ~kc_truth_var_word(v, w);
+    return Res;
+}
+// parses the input part of the cube; returns 0 if the cube has unexpected chars
+static inline int kc_read_cube(const std::string &cube, unsigned *care, unsigned *vals)
+{
+    size_t v;
+    *care = *vals = 0;
+    for (v = 0; v < cube.size(); v++)
+    {
+        if (cube[v] == '0')
+            *care |= 1 << v;
+        else if (cube[v] == '1')
+            *care |= 1 << v, *vals |= 1 << v;
+        else if (cube[v] != '-')
+            return 0;
+    }
+    return 1;
+}
+
+// reads the two-level SOP in PLA format (.i/.o/.p/.e); only the on-set is used
+static inline int kc_read_pla(FILE *pFile, kc_vt *outs)
+{
+    std::string line;
+    std::vector<std::string> tokens;
+    kc_vi Cubes, *cubes = &Cubes; // care and vals of each cube
+    kc_vi Bits, *bits = &Bits;    // the output part of each cube
+    int i, o, w, nVars = -1, nOuts = -1;
+    kc_vi_start(cubes, 100);
+    kc_vi_start(bits, 100);
+    while (kc_read_text_line(pFile, line))
+    {
+        kc_split_line(line, tokens);
+        if (tokens.empty())
+            continue;
+        if (tokens[0] == ".i" && tokens.size() > 1)
+            nVars = atoi(tokens[1].c_str());
+        else if (tokens[0] == ".o" && tokens.size() > 1)
+            nOuts = atoi(tokens[1].c_str());
+        else if (tokens[0] == ".e" || tokens[0] == ".end")
+            break;
+        else if (tokens[0][0] == '.')
+            continue;
+        else
+        {
+            unsigned care, vals;
+            if (nVars <= 0 || nVars > MAX_VARS || nOuts <= 0)
+            {
+                printf("The PLA file should declare between 1 and %d inputs (.i) and at least one output (.o).\n", MAX_VARS);
+                break;
+            }
+            std::string cube = tokens[0], out = tokens.size() > 1 ? tokens[1] : "";
+            if ((int)cube.size() == nVars + nOuts && out.empty()) // no space between the input and output parts
+                out = cube.substr(nVars), cube = cube.substr(0, nVars);
+            if ((int)cube.size() != nVars || (int)out.size() != nOuts || !kc_read_cube(cube, &care, &vals))
+            {
+                printf("Cannot parse the cube \"%s\" in the PLA file.\n", line.c_str());
+                nVars = -1;
+                break;
+            }
+            kc_vi_push(cubes, (int)care);
+            kc_vi_push(cubes, (int)vals);
+            for (o = 0; o < nOuts; o++)
+                kc_vi_push(bits, out[o] == '1' || out[o] == '4');
+        }
+    }
+    if (nVars <= 0 || nVars > MAX_VARS || nOuts <= 0)
+    {
+        kc_vi_stop(cubes);
+        kc_vi_stop(bits);
+        return 0;
+    }
+    kc_vt_start(outs, nOuts, kc_truth_word_num(nVars));
+    for (o = 0; o < nOuts; o++)
+        memset(kc_vt_append(outs), 0, 8 * outs->words);
+    for (i = 0; i < cubes->size / 2; i++)
+        for (w = 0; w < outs->words; w++)
+        {
+            kc_uint64 Cube = kc_truth_cube_word(cubes->ptr[2 * i], cubes->ptr[2 * i + 1], nVars, w);
+            if (Cube)
+                for (o = 0; o < nOuts; o++)
+                    if (bits->ptr[i * nOuts + o])
+                        kc_vt_read(outs, o)[w] |= Cube;
+        }
+    kc_vi_stop(cubes);
+    kc_vi_stop(bits);
+    return nVars;
+}
+
+// combinational node of the BLIF netlist
+typedef struct kc_blif_node_
+{
+    std::vector<int> fanins;        // the fanin signals
+    std::vector<std::string> cubes; // the input parts of the cover
+    int phase;                      // the output value of the cover (0 if the off-set is given)
+} kc_blif_node;
+
+static inline int kc_blif_signal(std::map<std::string, int> &names, const std::string &name)
+{
+    std::map<std::string, int>::iterator it = names.find(name);
+    if (it != names.end())
+        return it->second;
+    int Id = (int)names.size();
+    names[name] = Id;
+    return Id;
+}
+static inline int kc_blif_order_rec(std::vector<int> &drivers, std::vector<kc_blif_node> &nodes, std::vector<int> &marks, kc_vi *order, int s)
+{
+    if (marks[s] == 2)
+        return 1;
+    if (marks[s] == 1)
+        return 0; // combinational loop
+    if (drivers[s] == -1)
+        return 0; // undriven signal
+    marks[s] = 1;
+    for (size_t i = 0; i < nodes[drivers[s]].fanins.size(); i++)
+        if (!kc_blif_order_rec(drivers, nodes, marks, order, nodes[drivers[s]].fanins[i]))
+            return 0;
+    marks[s] = 2;
+    kc_vi_push(order, s);
+    return 1;
+}
+// reads the first model of the combinational BLIF file (.inputs/.outputs/.names)
+static inline int kc_read_blif(FILE *pFile, kc_vt *outs)
+{
+    std::string line;
+    std::vector<std::string> tokens;
+    std::map<std::string, int> names;
+    std::vector<kc_blif_node> nodes;
+    std::vector<int> ins, pos, drivers;
+    kc_blif_node *node = NULL;
+    size_t i, k;
+    int o, w, nVars = 0, fError = 0;
+    while (!fError && kc_read_text_line(pFile, line))
+    {
+        kc_split_line(line, tokens);
+        if (tokens.empty())
+            continue;
+        if (tokens[0] == ".model")
+            continue;
+        if (tokens[0] == ".end")
+            break;
+        if (tokens[0][0] == '.')
+            node = NULL;
+        if (tokens[0] == ".inputs")
+            for (i = 1; i < tokens.size(); i++)
+                ins.push_back(kc_blif_signal(names, tokens[i]));
+        else if (tokens[0] == ".outputs")
+            for (i = 1; i < tokens.size(); i++)
+                pos.push_back(kc_blif_signal(names, tokens[i]));
+        else if (tokens[0] == ".names" && tokens.size() > 1)
+        {
+            nodes.push_back(kc_blif_node());
+            node = &nodes.back();
+            node->phase = 1;
+            for (i = 1; i + 1 < tokens.size(); i++)
+                node->fanins.push_back(kc_blif_signal(names, tokens[i]));
+            int Driven = kc_blif_signal(names, tokens.back());
+            if ((int)drivers.size() <= Driven)
+                drivers.resize(Driven + 1, -1);
+            drivers[Driven] = (int)nodes.size() - 1;
+        }
+        else if (tokens[0][0] == '.')
+        {
+            printf("The BLIF directive \"%s\" is not supported (only combinational .names are).\n", tokens[0].c_str());
+            fError = 1;
+        }
+        else if (node && node->fanins.empty() && tokens.size() == 1 && (tokens[0] == "0" || tokens[0] == "1"))
+            node->cubes.push_back(""), node->phase = tokens[0] == "1";
+        else if (node && tokens.size() == 2 && tokens[0].size() == node->fanins.size() && (tokens[1] == "0" || tokens[1] == "1"))
+            node->cubes.push_back(tokens[0]), node->phase = tokens[1] == "1";
+        else
+        {
+            printf("Cannot parse the line \"%s\" in the BLIF file.\n", line.c_str());
+            fError = 1;
+        }
+    }
+    nVars = (int)ins.size();
+    if (!fError && (nVars == 0 || nVars > MAX_VARS || pos.empty()))
+    {
+        printf("The BLIF file should have between 1 and %d inputs and at least one output.\n", MAX_VARS);
+        fError = 1;
+    }
+    // find a topological order of the signals in the transitive fanin of the outputs
+    kc_vi Order, *order = &Order;
+    kc_vi_start(order, 100);
+    drivers.resize(names.size(), -1);
+    std::vector<int> marks(names.size(), 0);
+    for (i = 0; i < ins.size(); i++)
+        marks[ins[i]] = 2;
+    for (i = 0; !fError && i < pos.size(); i++)
+        if (!kc_blif_order_rec(drivers, nodes, marks, order, pos[i]))
+        {
+            printf("The BLIF file has an undriven signal or a combinational loop in the fanin of an output.\n");
+            fError = 1;
+        }
+    if (fError)
+    {
+        kc_vi_stop(order);
+        return 0;
+    }
+    // simulate the netlist one word at a time
+    std::vector<kc_uint64> vals(names.size(), 0);
+    kc_vt_start(outs, pos.size(), kc_truth_word_num(nVars));
+    for (o = 0; o < (int)pos.size(); o++)
+        kc_vt_append(outs);
+    for (w = 0; w < outs->words; w++)
+    {
+        for (i = 0; i < ins.size(); i++)
+            vals[ins[i]] = kc_truth_var_word((int)i, w);
+        for (o = 0; o < order->size; o++)
+        {
+            kc_blif_node *p = &nodes[drivers[order->ptr[o]]];
+            kc_uint64 Res = 0;
+            for (i = 0; i < p->cubes.size(); i++)
+            {
+                kc_uint64 Cube = ~(kc_uint64)0;
+                for (k = 0; k < p->fanins.size(); k++)
+                    if (p->cubes[i][k] == '0')
+                        Cube &= ~vals[p->fanins[k]];
+                    else if (p->cubes[i][k] == '1')
+                        Cube &= vals[p->fanins[k]];
+                Res |= Cube;
+            }
+            vals[order->ptr[o]] = p->phase ? Res : ~Res;
+        }
+        for (o = 0; o < (int)pos.size(); o++)
+            kc_vt_read(outs, o)[w] = vals[pos[o]];
+    }
+    kc_vi_stop(order);
+    return nVars;
+}
+
+// reads the combinational AIG in binary (aig) or ASCII (aag) AIGER format
+static inline int kc_read_aiger(FILE *pFile, kc_vt *outs)
+{
+    char Type[4] = {0};
+    int i, o, w, M, I, L, O, A;
+    if (fscanf(pFile, "%3s %d %d %d %d %d", Type, &M, &I, &L, &O, &A) != 6 || (strcmp(Type, "aig") && strcmp(Type, "aag")))
+    {
+        printf("Cannot parse the header of the AIGER file.\n");
+        return 0;
+    }
+    if (L > 0 || I == 0 || I > MAX_VARS || O == 0 || M < I + A)
+    {
+        printf("The AIGER file should be combinational and have between 1 and %d inputs and at least one output.\n", MAX_VARS);
+        return 0;
+    }
+    int fAscii = !strcmp(Type, "aag");
+    kc_vi Fans, *fans = &Fans; // two fanin literals of each object
+    kc_vi Tops, *tops = &Tops;
+    kc_vi_start(fans, 2 * (M + 1));
+    kc_vi_fill(fans, 2 * (M + 1), 0);
+    kc_vi_start(tops, O);
+    int Lit, Lit0, Lit1, fError = 0;
+    for (i = 0; fAscii && i < I; i++)
+        if (fscanf(pFile, "%d", &Lit) != 1 || Lit != 2 * (i + 1))
+            fError = 1; // inputs are expected to be numbered first
+    for (o = 0; o < O; o++)
+        if (fscanf(pFile, "%d", &Lit) != 1 || Lit < 0 || Lit > 2 * (I + A) + 1)
+            fError = 1; // the outputs are expected to be driven by the inputs or the AND-nodes
+        else
+            kc_vi_push(tops, Lit);
+    if (!fAscii)
+        fgetc(pFile); // skip the new-line after the last output
+    for (i = 0; !fError && i < A; i++)
+    {
+        if (fAscii)
+        {
+            if (fscanf(pFile, "%d %d %d", &Lit, &Lit0, &Lit1) != 3 || Lit != 2 * (1 + I + i))
+                fError = 1;
+        }
+        else
+        {
+            Lit = 2 * (1 + I + i);
+            Lit1 = Lit - (int)kc_aiger_read_uint(pFile);
+            Lit0 = Lit1 - (int)kc_aiger_read_uint(pFile);
+        }
+        if (Lit0 < 0 || Lit1 < 0 || Lit0 >= Lit || Lit1 >= Lit)
+            fError = 1; // the AND-nodes are expected to be in a topological order
+        else
+            fans->ptr[Lit] = Lit0, fans->ptr[Lit + 1] = Lit1;
+    }
+    if (fError)
+    {
+        printf("Cannot parse the body of the AIGER file.\n");
+        kc_vi_stop(fans);
+        kc_vi_stop(tops);
+        return 0;
+    }
+    // simulate the AIG one word at a time
+    kc_uint64 *vals = (kc_uint64 *)malloc(8 * (M + 1));
+    kc_vt_start(outs, O, kc_truth_word_num(I));
+    for (o = 0; o < O; o++)
+        kc_vt_append(outs);
+    for (w = 0; w < outs->words; w++)
+    {
+        vals[0] = 0;
+        for (i = 1; i <= I; i++)
+            vals[i] = kc_truth_var_word(i - 1, w);
+        for (i = 1 + I; i <= I + A; i++)
+        {
+            Lit0 = fans->ptr[2 * i], Lit1 = fans->ptr[2 * i + 1];
+            vals[i] = (vals[kc_l2v(Lit0)] ^ (kc_l2c(Lit0) ? ~(kc_uint64)0 : 0)) & (vals[kc_l2v(Lit1)] ^ (kc_l2c(Lit1) ? ~(kc_uint64)0 : 0));
+        }
+        kc_vi_for_each_entry(tops, Lit, o)
+            kc_vt_read(outs, o)[w] = vals[kc_l2v(Lit)] ^ (kc_l2c(Lit) ? ~(kc_uint64)0 : 0);
+    }
+    free(vals);
+    kc_vi_stop(fans);
+    kc_vi_stop(tops);
+    return I;
+}
+
+// the header of the binary truth-table file (.ttb), which is followed by the words of all truth tables
+typedef struct kc_ttb_header_
+{
+    char magic[4]; // "KCTT"
+    int version;   // the format version (also detects a different byte order)
+    int nvars;     // the number of inputs
+    int nouts;     // the number of outputs
+    int words;     // the number of 64-bit words in each truth table (as in kc_vt)
+    int pad[11];   // reserved to make the header KC_TTB_HEADER bytes long
+} kc_ttb_header;
+
+static inline int kc_ttb_check(kc_ttb_header *h, long long nBytes)
+{
+    if (memcmp(h->magic, "KCTT", 4) || h->version != 1)
+        printf("The file is not a binary truth-table file or was written on a platform with a different byte order.\n");
+    else if (h->nvars < 1 || h->nvars > MAX_VARS || h->nouts < 1 || h->words != kc_truth_word_num(h->nvars))
+        printf("The binary truth-table file has an invalid header.\n");
+    else if (nBytes != KC_TTB_HEADER + 8ll * h->nouts * h->words)
+        printf("The size of the binary truth-table file (%lld bytes) does not match its header.\n", nBytes);
+    else
+        return 1;
+    return 0;
+}
+// maps the binary truth-table file into memory; the tables are used in place (copy-on-write)
+static inline int kc_read_ttb(char *pFileName, kc_vt *outs)
+{
+    kc_ttb_header h;
+    assert(sizeof(kc_ttb_header) == KC_TTB_HEADER);
+#ifndef _WIN32
+    struct stat st;
+    int fd = open(pFileName, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size < KC_TTB_HEADER)
+    {
+        printf("Cannot open file \"%s\" for reading.\n", pFileName);
+        if (fd >= 0)
+            close(fd);
+        return 0;
+    }
+    char *base = (char *)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        printf("Cannot map file \"%s\" into memory.\n", pFileName);
+        return 0;
+    }
+    memcpy(&h, base, KC_TTB_HEADER);
+    if (!kc_ttb_check(&h, st.st_size))
+    {
+        munmap(base, st.st_size);
+        return 0;
+    }
+    outs->ptr = (kc_uint64 *)(base + KC_TTB_HEADER);
+    outs->mapped = st.st_size;
+#else
+    FILE *pFile = fopen(pFileName, "rb");
+    if (pFile == NULL || fread(&h, 1, KC_TTB_HEADER, pFile) != KC_TTB_HEADER)
+    {
+        printf("Cannot open file \"%s\" for reading.\n", pFileName);
+        if (pFile)
+            fclose(pFile);
+        return 0;
+    }
+    fseek(pFile, 0, SEEK_END);
+    long long nBytes = ftell(pFile);
+    fseek(pFile, KC_TTB_HEADER, SEEK_SET);
+    if (!kc_ttb_check(&h, nBytes))
+    {
+        fclose(pFile);
+        return 0;
+    }
+    outs->ptr = (kc_uint64 *)malloc(8 * h.nouts * h.words);
+    outs->mapped = 0;
+    if (fread(outs->ptr, 8, h.nouts * h.words, pFile) != (size_t)(h.nouts * h.words))
+        printf("Failed to read the truth tables from file \"%s\".\n", pFileName);
+    fclose(pFile);
+#endif
+    outs->size = outs->cap = h.nouts;
+    outs->words = h.words;
+    return h.nvars;
+}
+// writes the truth tables into the binary truth-table file
+static inline int kc_write_ttb(char *pFileName, int nvars, kc_vt *outs)
+{
+    kc_ttb_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "KCTT", 4);
+    h.version = 1;
+    h.nvars = nvars;
+    h.nouts = outs->size;
+    h.words = outs->words;
+    // the truth tables may be mapped from the file being replaced, so they are written into a temporary file first
+    std::string str = std::string(pFileName) + ".tmp";
+    FILE *pFile = fopen(str.c_str(), "wb");
+    if (pFile == NULL)
+    {
+        printf("Cannot open file \"%s\" for writing.\n", str.c_str());
+        return 0;
+    }
+    size_t nWords = (size_t)outs->size * outs->words;
+    int fOk = fwrite(&h, 1, KC_TTB_HEADER, pFile) == KC_TTB_HEADER && fwrite(kc_vt_array(outs), 8, nWords, pFile) == nWords;
+    fOk &= fclose(pFile) == 0;
+    if (!fOk || rename(str.c_str(), pFileName))
+    {
+        printf("Cannot write file \"%s\".\n", pFileName);
+        remove(str.c_str());
+        return 0;
+    }
+    return 1;
+}
+// the reader of the outputs in chunks from a text file with one truth table per line (.truth) or a binary file (.ttb)
+typedef struct kc_stream_
+{
+    FILE *pFile; // the input file
+    int fTtb;    // the file is a binary truth-table file
+    int nvars;   // the number of inputs
+    int nleft;   // the number of truth tables left in the binary file
+    kc_vi chars; // the characters of the next line of the text file
+} kc_stream;
+
+// reads the next nonempty line of the text file into the characters; returns 0 at the end of the file
+static inline int kc_stream_line(kc_stream *p)
+{
+    int c;
+    kc_vi_resize(&p->chars, 0);
+    while ((c = fgetc(p->pFile)) != EOF)
+    {
+        if (c == '\r' || c == '\t' || c == ' ')
+            continue;
+        if (c != '\n')
+            kc_vi_push(&p->chars, c);
+        else if (p->chars.size)
+            return 1;
+    }
+    return p->chars.size > 0;
+}
+// opens the file and returns the number of inputs (0 if the file cannot be read in chunks)
+static inline int kc_stream_start(kc_stream *p, char *pFileName)
+{
+    kc_vi_start(&p->chars, 1000);
+    p->fTtb = kc_file_has_ext(pFileName, ".ttb");
+    p->pFile = fopen(pFileName, "rb");
+    p->nvars = p->nleft = 0;
+    if (p->pFile == NULL)
+        printf("Cannot open file \"%s\" for reading.\n", pFileName);
+    else if (!strstr(pFileName, ".") || kc_file_has_ext(pFileName, ".pla") || kc_file_has_ext(pFileName, ".blif") ||
+             kc_file_has_ext(pFileName, ".aig") || kc_file_has_ext(pFileName, ".aag"))
+        printf("Only the files of truth tables (.truth or .ttb) can be read in chunks.\n");
+    else if (p->fTtb)
+    {
+        kc_ttb_header h;
+        fseek(p->pFile, 0, SEEK_END);
+        long long nBytes = ftell(p->pFile);
+        fseek(p->pFile, 0, SEEK_SET);
+        if (fread(&h, 1, KC_TTB_HEADER, p->pFile) == KC_TTB_HEADER && kc_ttb_check(&h, nBytes))
+            p->nvars = h.nvars, p->nleft = h.nouts;
+    }
+    else if (kc_stream_line(p))
+    {
+        p->nvars = kc_log2(p->chars.size);
+        if ((1 << p->nvars) != p->chars.size || p->nvars > MAX_VARS)
+            printf("The input string length (%d chars) is not the size of the truth table of a function with at most %d inputs.\n",
+                   p->chars.size, MAX_VARS), p->nvars = 0;
+    }
+    if (p->nvars == 0 && p->pFile)
+        fclose(p->pFile), p->pFile = NULL;
+    if (p->nvars == 0)
+        kc_vi_stop(&p->chars);
+    return p->nvars;
+}
+// replaces the truth tables by the next chunk of at most nMax of them; returns their number (-1 if the file is corrupted)
+static inline int kc_stream_read(kc_stream *p, kc_vt *outs, int nMax)
+{
+    int words = kc_truth_word_num(p->nvars);
+    kc_vt_restart(outs, nMax, words);
+    if (p->fTtb)
+    {
+        int n = kc_min(nMax, p->nleft);
+        if (n > 0 && fread(kc_vt_array(outs), 8, (size_t)n * words, p->pFile) != (size_t)n * words)
+        {
+            printf("Failed to read the truth tables from the binary file.\n");
+            return -1;
+        }
+        p->nleft -= n, outs->size = n;
+        return n;
+    }
+    while (outs->size < nMax && p->chars.size)
+    {
+        if ((1 << p->nvars) != p->chars.size)
+        {
+            printf("The input string length (%d chars) does not match the size (%d bits) of the truth table of %d-var function.\n",
+                   p->chars.size, 1 << p->nvars, p->nvars);
+            return -1;
+        }
+        kc_read_line(outs, &p->chars, p->nvars);
+        kc_stream_line(p);
+    }
+    return outs->size;
+}
+static inline void kc_stream_stop(kc_stream *p)
+{
+    fclose(p->pFile);
+    kc_vi_stop(&p->chars);
+}
+
+static inline int kc_read_input_data(char *pInput, kc_vt *outs)
+{
+    if (kc_file_has_ext(pInput, ".ttb"))
+    { // pInput is a binary truth-table file
+        int nVars = kc_read_ttb(pInput, outs);
+        if (nVars)
+            printf("Finished entring %d-input %d-output function from file \"%s\".\n", nVars, outs->size, pInput);
+        return nVars;
+    }
+    if (strstr(pInput, "."))
+    { // pInput is a file name
+        FILE *pFile = fopen(pInput, "rb");
+        if (pFile == NULL)
+        {
+            printf("Cannot open file \"%s\" for reading.\n", pInput);
+            return 0;
+        }
+        int nVars;
+        if (kc_file_has_ext(pInput, ".pla"))
+            nVars = kc_read_pla(pFile, outs);
+        else if (kc_file_has_ext(pInput, ".blif"))
+            nVars = kc_read_blif(pFile, outs);
+        else if (kc_file_has_ext(pInput, ".aig") || kc_file_has_ext(pInput, ".aag"))
+            nVars = kc_read_aiger(pFile, outs);
+        else
+            nVars = kc_read_file(pFile, outs);
+        if (nVars == 0)
+        {
+            fclose(pFile);
+            return 0;
+        }
+        // kc_vt_print2_all( outs );
+        printf("Finished entring %d-input %d-output function from file \"%s\".\n", nVars, outs->size, pInput);
+        fclose(pFile);
+        return nVars;
+    }
+    else
+    { // pInput is a truth table
+        int nChars = strlen(pInput);
+        int nVars = kc_log2(4 * nChars);
+        if ((1 << nVars) != 4 * nChars)
+        {
+            printf("The input string length (%d chars) does not match the size (%d bits) of the truth table of %d-var function.\n",
+                   nChars, 1 << nVars, nVars);
+            return 0;
+        }
+        kc_vt_start(outs, 1, kc_truth_word_num(nVars));
+        kc_read_hex(pInput, nChars, nVars, outs);
+        kc_vt_print_all(outs);
+        printf("Finished entring %d-input %d-output function.\n", nVars, 1);
+        return nVars;
+    }
+}
+
+/*************************************************************
+                 Archives of many problems
+**************************************************************/
+
+// the archive (.kca) holds the header, the data of all items, and the index of items
+typedef struct kc_arc_header_
+{
+    char magic[4];   // "KCAR"
+    int version;     // the format version (also detects a different byte order)
+    int kind;        // the kind of items (KC_ARC_TRUTHS or KC_ARC_AIGS)
+    int nitems;      // the number of items
+    long long index; // the position of the index in the file
+    int pad[10];     // reserved to make the header 64 bytes long
+} kc_arc_header;
+
+// the entry of the index describing one item (the index of results doubles as the table of statistics)
+typedef struct kc_arc_entry_
+{
+    long long offset; // the position of the item's data in the file
+    long long bytes;  // the size of the item's data
+    int nvars;        // the number of inputs
+    int nouts;        // the number of outputs
+    int cost;         // the number of nodes in the result (-1 for problems)
+    int pad;          // reserved
+    char name[32];    // the name of the problem
+} kc_arc_entry;
+
+#define KC_ARC_TRUTHS 0 // the items are the truth tables of the problems (as in kc_vt)
+#define KC_ARC_AIGS 1   // the items are the resulting AIGs (as in AIGER files)
+
+// starts writing the archive (the header is written by kc_arc_stop)
+static inline FILE *kc_arc_start(const char *pFileName)
+{
+    char Zeros[sizeof(kc_arc_header)] = {0};
+    FILE *pFile = fopen(pFileName, "wb");
+    if (pFile == NULL)
+    {
+        printf("Cannot open file \"%s\" for writing.\n", pFileName);
+        return NULL;
+    }
+    fwrite(Zeros, 1, sizeof(kc_arc_header), pFile);
+    return pFile;
+}
+// adds the entry of the item whose data was written into the archive starting at the given position
+static inline void kc_arc_add(FILE *pFile, std::vector<kc_arc_entry> &entries, long long offset, const char *pName, int nvars, int nouts, int cost)
+{
+    kc_arc_entry e;
+    memset(&e, 0, sizeof(e));
+    e.offset = offset;
+    e.bytes = ftell(pFile) - offset;
+    e.nvars = nvars;
+    e.nouts = nouts;
+    e.cost = cost;
+    memcpy(e.name, pName, kc_min((int)strlen(pName), (int)sizeof(e.name) - 1));
+    entries.push_back(e);
+}
+// writes the index and the header, and closes the archive
+static inline void kc_arc_stop(FILE *pFile, int kind, std::vector<kc_arc_entry> &entries)
+{
+    kc_arc_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "KCAR", 4);
+    h.version = 1;
+    h.kind = kind;
+    h.nitems = (int)entries.size();
+    h.index = ftell(pFile);
+    if (!entries.empty())
+        fwrite(&entries[0], sizeof(kc_arc_entry), entries.size(), pFile);
+    fseek(pFile, 0, SEEK_SET);
+    fwrite(&h, sizeof(h), 1, pFile);
+    fclose(pFile);
+}
+// opens the archive and reads its header
+static inline FILE *kc_arc_open(char *pFileName, kc_arc_header *h)
+{
+    FILE *pFile = fopen(pFileName, "rb");
+    if (pFile == NULL)
+    {
+        printf("Cannot open file \"%s\" for reading.\n", pFileName);
+        return NULL;
+    }
+    if (fread(h, sizeof(kc_arc_header), 1, pFile) != 1 || memcmp(h->magic, "KCAR", 4) || h->version != 1 || h->nitems < 0)
+    {
+        printf("The file \"%s\" is not an archive or was written on a platform with a different byte order.\n", pFileName);
+        fclose(pFile);
+        return NULL;
+    }
+    return pFile;
+}
+// reads the entry of the given item (random access by the item index)
+static inline int kc_arc_read_entry(FILE *pFile, kc_arc_header *h, int id, kc_arc_entry *e)
+{
+    assert(id >= 0 && id < h->nitems);
+    fseek(pFile, h->index + (long long)id * sizeof(kc_arc_entry), SEEK_SET);
+    return fread(e, sizeof(kc_arc_entry), 1, pFile) == 1;
+}
+// reads the truth tables of the problem; returns the number of inputs
+static inline int kc_arc_read_truths(FILE *pFile, kc_arc_entry *e, kc_vt *outs)
+{
+    int words = kc_truth_word_num(e->nvars);
+    if (e->nvars < 1 || e->nvars > MAX_VARS || e->nouts < 1 || e->bytes != 8ll * e->nouts * words)
+    {
+        printf("The archive entry of problem \"%s\" is invalid.\n", e->name);
+        return 0;
+    }
+    kc_vt_start(outs, e->nouts, words);
+    outs->size = e->nouts;
+    fseek(pFile, e->offset, SEEK_SET);
+    if (fread(kc_vt_array(outs), 8, e->nouts * words, pFile) != (size_t)(e->nouts * words))
+    {
+        printf("Failed to read the truth tables of problem \"%s\".\n", e->name);
+        kc_vt_stop(outs);
+        return 0;
+    }
+    return e->nvars;
+}
+
+/*************************************************************
+                 Rewriting the resulting AIG
+**************************************************************/
+
+#define KC_CUT_SIZE 4   // the largest number of leaves in a cut
+#define KC_CUT_NUM 8    // the largest number of non-trivial cuts kept for each node
+#define KC_RW_PASSES 3  // the largest number of rewriting passes
+
+typedef struct kc_cut_
+{
+    int nleaves;
+    int leaves[KC_CUT_SIZE]; // in increasing order
+} kc_cut;
+
+// computes the cuts of the node by merging the cuts of its fanins (the trivial cut is not stored)
+static inline void kc_rw_cuts(kc_gg *gg, int v, std::vector<std::vector<kc_cut>> &cuts)
+{
+    int f, i, j, k, n, m;
+    kc_cut Triv[2];
+    std::vector<kc_cut> *pFan[2];
+    std::vector<kc_cut> &Res = cuts[v];
+    Res.clear();
+    for (f = 0; f < 2; f++)
+    {
+        Triv[f].nleaves = 1;
+        Triv[f].leaves[0] = kc_l2v(kc_gg_fanin(gg, v, f));
+        pFan[f] = &cuts[Triv[f].leaves[0]];
+    }
+    for (i = -1; i < (int)pFan[0]->size(); i++)
+        for (j = -1; j < (int)pFan[1]->size(); j++)
+        {
+            kc_cut *c0 = i < 0 ? &Triv[0] : &(*pFan[0])[i];
+            kc_cut *c1 = j < 0 ? &Triv[1] : &(*pFan[1])[j];
+            kc_cut New;
+            for (n = m = New.nleaves = 0; n < c0->nleaves || m < c1->nleaves; New.nleaves++)
+            {
+                if (New.nleaves == KC_CUT_SIZE)
+                    break;
+                if (m == c1->nleaves || (n < c0->nleaves && c0->leaves[n] < c1->leaves[m]))
+                    New.leaves[New.nleaves] = c0->leaves[n++];
+                else if (n == c0->nleaves || c1->leaves[m] < c0->leaves[n])
+                    New.leaves[New.nleaves] = c1->leaves[m++];
+                else
+                    New.leaves[New.nleaves] = c0->leaves[n++], m++;
+            }
+            if (n < c0->nleaves || m < c1->nleaves)
+                continue;
+            for (k = 0; k < (int)Res.size(); k++)
+                if (Res[k].nleaves == New.nleaves && !memcmp(Res[k].leaves, New.leaves, sizeof(int) * New.nleaves))
+                    break;
+            if (k < (int)Res.size())
+                continue;
+            // keep the smallest cuts
+            if ((int)Res.size() == KC_CUT_NUM && Res.back().nleaves <= New.nleaves)
+                continue;
+            if ((int)Res.size() == KC_CUT_NUM)
+                Res.pop_back();
+            for (k = (int)Res.size(); k > 0 && Res[k - 1].nleaves > New.nleaves; k--)
+                ;
+            Res.insert(Res.begin() + k, New);
+        }
+}
+
+// computes the function of the node in terms of the cut leaves
+static inline unsigned kc_rw_truth_rec(kc_gg *gg, int v, std::vector<unsigned> &sims)
+{
+    if (kc_gg_tid_is_cur(gg, v))
+        return sims[v];
+    kc_gg_tid_set_cur(gg, v);
+    assert(kc_gg_is_node(gg, v));
+    int lit0 = kc_gg_fanin(gg, v, 0), lit1 = kc_gg_fanin(gg, v, 1);
+    unsigned t0 = kc_rw_truth_rec(gg, kc_l2v(lit0), sims) ^ (kc_l2c(lit0) ? 0xFFFF : 0);
+    unsigned t1 = kc_rw_truth_rec(gg, kc_l2v(lit1), sims) ^ (kc_l2c(lit1) ? 0xFFFF : 0);
+    return sims[v] = t0 & t1;
+}
+static inline unsigned kc_rw_truth(kc_gg *gg, int v, kc_cut *cut, std::vector<unsigned> &sims)
+{
+    static unsigned s_Elems[4] = {0xAAAA, 0xCCCC, 0xF0F0, 0xFF00};
+    int k;
+    kc_gg_tid_increment(gg);
+    kc_gg_tid_set_cur(gg, 0);
+    sims[0] = 0;
+    for (k = 0; k < cut->nleaves; k++)
+    {
+        kc_gg_tid_set_cur(gg, cut->leaves[k]);
+        sims[cut->leaves[k]] = s_Elems[k];
+    }
+    return kc_rw_truth_rec(gg, v, sims);
+}
+
+// dereferences (fAdd = -1) or references (fAdd = 1) the nodes of the cone above the cut;
+// returns the number of nodes whose reference counter reaches zero (the maximum fanout-free cone)
+static inline int kc_rw_ref_rec(kc_gg *gg, int v, kc_cut *cut, std::vector<int> &refs, int fAdd)
+{
+    int f, k, Count = 1;
+    for (f = 0; f < 2; f++)
+    {
+        int w = kc_l2v(kc_gg_fanin(gg, v, f));
+        int fLeaf = !kc_gg_is_node(gg, w);
+        for (k = 0; k < cut->nleaves; k++)
+            fLeaf |= cut->leaves[k] == w;
+        if (fAdd < 0 ? --refs[w] == 0 : refs[w]++ == 0)
+            if (!fLeaf)
+                Count += kc_rw_ref_rec(gg, w, cut, refs, fAdd);
+    }
+    return Count;
+}
+
+// returns the used node of the graph with the given fanins (-1 if there is no such node)
+static inline int kc_rw_lookup(std::unordered_map<long long, int> &hash, std::vector<int> &refs, int lit1, int lit2)
+{
+    if (lit1 < 0 || lit2 < 0)
+        return -1;
+    if (lit1 == 0 || lit2 == 0 || (lit1 ^ lit2) == 1)
+        return 0;
+    if (lit1 == 1 || lit1 == lit2)
+        return lit2;
+    if (lit2 == 1)
+        return lit1;
+    if (lit1 > lit2)
+        KC_SWAP(int, lit1, lit2)
+    std::unordered_map<long long, int>::iterator it = hash.find(((long long)lit1 << 32) | lit2);
+    return it != hash.end() && refs[it->second] > 0 ? kc_v2l(it->second, 0) : -1;
+}
+// the number of and-nodes added by the structure on top of the cut
+// (the used nodes of the graph that are not in the replaced cone are shared)
+static inline int kc_rw_structure_cost(std::vector<int> &Str, kc_cut *cut, std::unordered_map<long long, int> &hash, std::vector<int> &refs)
+{
+    int k, Count = 0, Lits[2 * (5 + 64)];
+    Lits[0] = 0, Lits[1] = 1;
+    for (k = 0; k < 4; k++)
+        Lits[2 * (1 + k)] = k < cut->nleaves ? kc_v2l(cut->leaves[k], 0) : 0, Lits[2 * (1 + k) + 1] = kc_lnot(Lits[2 * (1 + k)]);
+    for (k = 0; 2 * k + 1 < (int)Str.size(); k++)
+    {
+        int Lit = kc_rw_lookup(hash, refs, Lits[Str[1 + 2 * k]], Lits[Str[2 + 2 * k]]);
+        Count += Lit < 0;
+        Lits[2 * (5 + k)] = Lit, Lits[2 * (5 + k) + 1] = Lit < 0 ? -1 : kc_lnot(Lit);
+    }
+    return Count;
+}
+
+// copies the node into the new graph using the chosen replacements
+static inline int kc_rw_build_rec(kc_gg *ggNew, kc_gg *gg, int v, std::vector<int> &copies, std::vector<int> &repl,
+                                  std::vector<kc_cut> &cuts, std::vector<unsigned> &truths)
+{
+    if (copies[v] >= 0)
+        return copies[v];
+    if (repl[v] >= 0)
+    {
+        kc_cut *cut = &cuts[repl[v]];
+        int k, Leaves[4] = {0, 0, 0, 0};
+        for (k = 0; k < cut->nleaves; k++)
+            Leaves[k] = kc_rw_build_rec(ggNew, gg, cut->leaves[k], copies, repl, cuts, truths);
+        return copies[v] = kc_rw_build_structure(ggNew, kc_rw_structure(truths[repl[v]], 0), Leaves);
+    }
+    int lit0 = kc_gg_fanin(gg, v, 0), lit1 = kc_gg_fanin(gg, v, 1);
+    int c0 = kc_lnotc(kc_rw_build_rec(ggNew, gg, kc_l2v(lit0), copies, repl, cuts, truths), kc_l2c(lit0));
+    int c1 = kc_lnotc(kc_rw_build_rec(ggNew, gg, kc_l2v(lit1), copies, repl, cuts, truths), kc_l2c(lit1));
+    return copies[v] = kc_gg_and(ggNew, c0, c1);
+}
+
+// one pass of rewriting the and-only graph: each node in the topological order is replaced by the structure
+// of one of its cuts if this reduces the number of nodes; returns the new graph
+static inline kc_gg *kc_rw_pass(kc_gg *gg)
+{
+    int i, k, v, top;
+    std::vector<std::vector<kc_cut>> Cuts(gg->size);
+    std::vector<unsigned> Sims(gg->size);
+    std::vector<int> Refs(gg->size, 0), Repl(gg->size, -1);
+    std::vector<kc_cut> ReplCuts;
+    std::vector<unsigned> ReplTruths;
+    std::unordered_map<long long, int> Hash;
+    // count the references of the used nodes and hash them by their fanins
+    kc_gg_node_count(gg);
+    for (v = 1 + gg->nins; v < gg->size; v++)
+        if (kc_gg_tid_is_cur(gg, v))
+        {
+            Refs[kc_l2v(kc_gg_fanin(gg, v, 0))]++, Refs[kc_l2v(kc_gg_fanin(gg, v, 1))]++;
+            Hash[((long long)kc_gg_fanin(gg, v, 0) << 32) | kc_gg_fanin(gg, v, 1)] = v;
+        }
+    kc_vi_for_each_entry(&gg->tops, top, i)
+        Refs[kc_l2v(top)]++;
+    for (v = 1 + gg->nins; v < gg->size; v++)
+    {
+        if (Refs[v] == 0)
+            continue;
+        kc_rw_cuts(gg, v, Cuts);
+        int iBest = -1, GainBest = 0;
+        unsigned TruthBest = 0;
+        for (k = 0; k < (int)Cuts[v].size(); k++)
+        {
+            kc_cut *cut = &Cuts[v][k];
+            int nMffc = kc_rw_ref_rec(gg, v, cut, Refs, -1), Gain = 0;
+            unsigned uTruth = 0;
+            if (nMffc > 1)
+            {
+                uTruth = kc_rw_truth(gg, v, cut, Sims);
+                Gain = nMffc - kc_rw_structure_cost(kc_rw_structure(uTruth, 0), cut, Hash, Refs);
+            }
+            kc_rw_ref_rec(gg, v, cut, Refs, 1);
+            if (GainBest < Gain)
+                GainBest = Gain, iBest = k, TruthBest = uTruth;
+        }
+        if (iBest < 0)
+            continue;
+        // replace the cone above the cut by the structure
+        kc_cut Cut = Cuts[v][iBest];
+        kc_rw_ref_rec(gg, v, &Cut, Refs, -1);
+        for (k = 0; k < Cut.nleaves; k++)
+            Refs[Cut.leaves[k]]++;
+        Repl[v] = (int)ReplCuts.size();
+        ReplCuts.push_back(Cut);
+        ReplTruths.push_back(TruthBest);
+        Cuts[v].clear(); // the cuts of the fanouts do not cross the replaced node
+    }
+    // build the new graph
+    kc_gg *ggNew = kc_gg_start(gg->nins, &gg->outs);
+    std::vector<int> Copies(gg->size, -1);
+    Copies[0] = 0;
+    for (i = 1; i <= gg->nins; i++)
+        Copies[i] = kc_v2l(i, 0);
+    kc_vi_for_each_entry(&gg->tops, top, i)
+        kc_vi_push(&ggNew->tops, kc_lnotc(kc_rw_build_rec(ggNew, gg, kc_l2v(top), Copies, Repl, ReplCuts, ReplTruths), kc_l2c(top)));
+    return ggNew;
+}
+
+// rewrites the graph after expanding xor-gates into and-gates; returns the and-only graph, whose inputs
+// follow the variable order of the user's function (the copy without rewriting if rewriting does not help)
+static inline kc_gg *kc_gg_rewrite(kc_gg *gg, int verbose)
+{
+    int i, Pass, top;
+    kc_gg_node_count(gg);
+    kc_gg *ggAnd = kc_gg_dup(gg, 1), *ggBest = ggAnd;
+    int nStart = kc_gg_node_count(ggAnd), nBest = nStart;
+    for (Pass = 0; Pass < KC_RW_PASSES; Pass++)
+    {
+        kc_gg *ggNew = kc_rw_pass(ggBest);
+        int nNew = kc_gg_node_count(ggNew), fFailed = 0;
+        kc_vi_for_each_entry(&ggNew->tops, top, i)
+            fFailed |= !kc_vt_is_equal2(&ggNew->tts, top, &ggAnd->tts, kc_vi_read(&ggAnd->tops, i));
+        if (fFailed)
+            printf("Rewriting changed the functions of the outputs and is skipped.\n");
+        if (fFailed || nNew >= nBest)
+        {
+            kc_gg_stop(ggNew);
+            break;
+        }
+        if (ggBest != ggAnd)
+            kc_gg_stop(ggBest);
+        ggBest = ggNew, nBest = nNew;
+    }
+    if (verbose)
+        printf("Rewriting reduced the AIG from %d to %d and-nodes in %d passes.\n", nStart, nBest, Pass);
+    if (ggBest != ggAnd)
+        kc_gg_stop(ggAnd);
+    return ggBest;
+}
+
+/*************************************************************
+                  Top level procedures
+**************************************************************/
+
+// parameters of synthesis
+typedef struct kc_par_
+{
+    int try_perm; // enables trying all variable orders
+    int and_only; // enables using only and-gates (no xor-gates)
+    int phase;    // enables complementing skew-symmetric variables to make them symmetric
+    int verbose;  // enables verbose output
+    double time_limit; // the wall-clock time limit of trying variable orders in seconds (0 = no limit)
+    int mem_limit;     // the memory limit of trying variable orders in megabytes (0 = no limit)
+    int top_k;         // the number of orders with the smallest estimated cost to synthesize (0 = all orders)
+    int delay;         // enables minimizing the number of levels before the number of nodes
+    int max_level;     // the number of levels under which the number of nodes is minimized (0 = no bound)
+    int rewrite;       // enables rewriting the resulting AIG before writing it
+    int est_best;      // enables synthesizing the order with the smallest estimated cost found by dynamic programming
+    int fprm;          // enables trying the best fixed-polarity Reed-Muller form of the outputs
+    const char *format; // the format of the output file ("aig", "blif", or "v")
+    int verify;        // the verification (0 = stored truth tables, 1 = simulation, 2 = simulation of random words)
+    int threads;       // the number of threads used by the verification by simulation
+    int lib;           // enables taking the functions of the bottom variables from the library of structures
+    long long shard_id;  // the index of the slice of the variable orders tried by this run
+    long long shard_num; // the number of slices of the variable orders (0 = no slicing)
+    int merge;           // the number of slices whose best orders are merged before synthesis
+    const char *shard_file; // the file receiving the best order of the slice
+    const char *ckpt_file;  // the file saving the state of the search over variable orders (NULL = no saving)
+    int resume;             // enables continuing the search from the state saved in the file
+    int chunk;              // the number of outputs read and synthesized at a time (0 = all outputs at once)
+    int portfolio;          // enables running several strategies in parallel and keeping the best result
+    int quiet;              // disables the progress reports of the search over variable orders
+    std::atomic<long long> *bound; // the smallest number of and-nodes found by the portfolio (NULL = no bound)
+    std::atomic<int> *cancel;      // the flag stopping the synthesis and the search at the deadline of the portfolio
+} kc_par;
+
+static inline void kc_par_default(kc_par *par) { memset(par, 0, sizeof(kc_par)); }
+
+// verifies the result (the outputs starting from iFirst) as selected by the parameters; returns the number of failed outputs
+static inline int kc_top_level_verify(kc_gg *gg, kc_par *par, int iFirst)
+{
+    int i, nFailed = 0;
+    if (par->verify)
+        return kc_gg_verify_sim(gg, kc_max(1, par->threads), par->verify == 2 ? KC_SIM_RANDOM : 0, iFirst);
+    for (i = iFirst; i < kc_vi_size(&gg->tops); i++)
+        nFailed += !kc_vt_is_equal2(&gg->outs, i - iFirst, &gg->tts, kc_vi_read(&gg->tops, i));
+    return nFailed;
+}
+
+#define KC_PROGRESS_PERIOD 1.0    // the period of progress reports in the anytime search (in seconds)
+#define KC_ANYTIME_RANK_MAX (1 << 22) // the largest number of orders ranked by the estimated cost in the anytime search
+#define KC_ANYTIME_TOP 4096           // the number of orders with the smallest estimated cost tried first in the anytime search
+#define KC_CHECKPOINT_PERIOD 60.0 // the period of saving the state of the search over variable orders (in seconds)
+
+// solve the problem for one variable order using the graph started for it; returns 0 if the synthesis is cancelled
+// at the deadline or because the nodes of the outputs synthesized so far already exceed the bound (the result is then incomplete)
+static inline int kc_top_level_synth(kc_gg *gg, kc_par *par)
+{
+    int i, top, nvars = gg->nins;
+    gg->cancel = par->cancel;
+    gg->delay = par->delay;
+    gg->max_level = par->max_level;
+    gg->lib = par->lib && !par->delay; // the structures are chosen by the number of nodes only
+    KC_PROF_COUNT(KC_PROF_SYNTH);
+    KC_PROF_TIME(KC_PROF_SYNTH);
+    for (i = 0; i < kc_vt_size(&gg->outs); i++)
+    {
+        kc_vt_resize(&gg->funcs, 0);
+        kc_vt_move(&gg->funcs, &gg->outs, i);
+        if (par->and_only)
+            top = synthesis_and_rec(gg, 0, nvars - 1);
+        else
+            top = synthesis_xor_rec(gg, 0, nvars - 1);
+        if (par->cancel && *par->cancel) // the recursion may have been cut, so the output is left without a driver
+            return 0;
+        kc_vi_push(&gg->tops, top);
+        kc_gg_compact(gg);
+        if (par->bound && gg->size - 1 - nvars > *par->bound) // all nodes are used after compacting
+            return 0;
+        if (gg->mem_limit && kc_gg_memory(gg) > gg->mem_limit)
+            return 0;
+    }
+    // the structures may lose the sharing of the recursion, so the circuit without them is kept if it is smaller
+    // (unless the graph keeps the outputs of the previous chunks)
+    if (gg->lib && kc_vi_size(&gg->tops) == kc_vt_size(&gg->outs))
+    {
+        kc_par ParRec = *par;
+        ParRec.lib = 0;
+        kc_gg *ggRec = kc_gg_start(nvars, &gg->outs);
+        ggRec->mem_limit = gg->mem_limit;
+        if (kc_top_level_synth(ggRec, &ParRec))
+        {
+            std::vector<int> Objs, Outs;
+            int nAnds = kc_gg_aiger_expand(gg, Objs, Outs), nAndsRec = kc_gg_aiger_expand(ggRec, Objs, Outs);
+            if (nAndsRec < nAnds || (nAndsRec == nAnds && kc_gg_node_count(ggRec) < kc_gg_node_count(gg)))
+                KC_SWAP(kc_gg, *gg, *ggRec)
+        }
+        kc_gg_stop(ggRec);
+    }
+    return 1;
+}
+
+// solve the problem for one variable order
+static inline kc_gg *kc_top_level_call_one(int nvars, kc_vt *outs, kc_par *par)
+{
+    kc_gg *gg = kc_gg_start(nvars, outs);
+    kc_top_level_synth(gg, par);
+    return gg;
+}
+
+// the orders tried first in the anytime search: the variables sorted by influence in both directions
+// (pInit labels the variables at each position of the truth tables)
+static inline void kc_perm_seeds(kc_vt *outs, int nvars, int *pInit, std::vector<int> &Cands)
+{
+    long long Infl[MAX_VARS];
+    int i, k, Pos[MAX_VARS];
+    for (i = 0; i < nvars; i++)
+    {
+        Infl[i] = kc_vt_influence(outs, i);
+        for (k = i; k > 0 && Infl[Pos[k - 1]] > Infl[i]; k--)
+            Pos[k] = Pos[k - 1];
+        Pos[k] = i;
+    }
+    for (i = 0; i < nvars; i++)
+        Cands.push_back(pInit[Pos[i]]);
+    for (i = 0; i < nvars; i++)
+        Cands.push_back(pInit[Pos[nvars - 1 - i]]);
+}
+static inline int kc_perm_is_cand(int *pPerm, std::vector<int> &Cands, int nvars)
+{
+    for (int i = 0; i < (int)Cands.size(); i += nvars)
+        if (!memcmp(pPerm, &Cands[i], sizeof(int) * nvars))
+            return 1;
+    return 0;
+}
+// the variables at the positions of the order given by class labels (the members of each class are taken in increasing order)
+static inline void kc_perm_vars(int *pLabels, int *pClass, int nvars, int *pVars)
+{
+    int k, v, Next[MAX_VARS];
+    for (k = 0; k < nvars; k++)
+        Next[k] = k;
+    for (k = 0; k < nvars; k++)
+    {
+        pVars[k] = v = Next[pLabels[k]];
+        for (v++; v < nvars && pClass[v] != pLabels[k]; v++)
+            ;
+        Next[pLabels[k]] = v;
+    }
+}
+// ranks all orders by the estimated cost and collects the best nTop of them in Cands (from the best to the worst)
+static inline void kc_perm_rank(int *pCost, int nvars, int *pClass, int *pInit, long long nOrders, int nTop, std::vector<int> &Cands,
+                                std::atomic<int> *pCancel)
+{
+    std::priority_queue<std::pair<int, long long>> Heap; // the estimated cost and the index of the best orders so far
+    int Perm[MAX_VARS], Vars[MAX_VARS];
+    long long i;
+    memcpy(Perm, pInit, sizeof(int) * nvars);
+    for (i = 0; i < nOrders; i++)
+    {
+        kc_perm_vars(Perm, pClass, nvars, Vars);
+        std::pair<int, long long> Entry(kc_est_order(pCost, Vars, nvars), i);
+        if ((int)Heap.size() < nTop)
+            Heap.push(Entry);
+        else if (Entry < Heap.top())
+            Heap.pop(), Heap.push(Entry);
+        kc_get_next_perm(Perm, nvars, NULL);
+        if (pCancel && (i & 0xFFFF) == 0 && *pCancel) // rank the orders seen so far
+            nOrders = i + 1;
+    }
+    // enumerate the orders again to collect the best ones
+    std::vector<std::pair<long long, int>> Best; // the index of each best order and its rank
+    for (; !Heap.empty(); Heap.pop())
+        Best.push_back(std::make_pair(Heap.top().second, (int)Heap.size() - 1));
+    std::sort(Best.begin(), Best.end());
+    Cands.resize((size_t)Best.size() * nvars);
+    memcpy(Perm, pInit, sizeof(int) * nvars);
+    int k = 0;
+    for (i = 0; k < (int)Best.size(); i++)
+    {
+        if (Best[k].first == i)
+            memcpy(&Cands[(size_t)Best[k++].second * nvars], Perm, sizeof(int) * nvars);
+        kc_get_next_perm(Perm, nvars, NULL);
+    }
+}
+
+// synthesize the current order in the reused graph and remember it if it is the best one so far
+// (with the library, the cost counts the and-nodes written for the graph instead of its nodes; the orders
+// of the same cost are compared by the and-nodes, kept in *pAndsBest; returns the number of nodes;
+// pLevel receives the number of levels)
+static inline int kc_top_level_try_order(kc_gg *ggTemp, int nvars, kc_vt *outs, kc_par *par, int *currPerm,
+                                         int *pLevel, long long *pCostBest, int *pAndsBest, int *bestPerm)
+{
+    kc_gg_restart(ggTemp, nvars, outs);
+    // the order is dropped as soon as its graph takes the half of the memory limit reserved for the search
+    ggTemp->mem_limit = par->mem_limit > 0 ? ((size_t)par->mem_limit << 19) : 0;
+    if (!kc_top_level_synth(ggTemp, par))
+        return *pLevel = 0, -1; // the order exceeds the memory limit or cannot improve the best result of the portfolio
+    int CostThis = kc_gg_node_count(ggTemp);
+    *pLevel = kc_gg_level(ggTemp);
+    std::vector<int> Objs, Outs;
+    int nAnds = par->lib ? kc_gg_aiger_expand(ggTemp, Objs, Outs) : kc_gg_and_count(ggTemp);
+    long long Cost = kc_gg_cost(ggTemp, *pLevel, par->lib ? nAnds : CostThis);
+    if (*pCostBest > Cost || (*pCostBest == Cost && *pAndsBest > nAnds))
+    {
+        *pCostBest = Cost, *pAndsBest = nAnds;
+        memcpy(bestPerm, currPerm, sizeof(int) * nvars);
+    }
+    return CostThis;
+}
+
+// returns the reason for stopping the search if the next order is not expected to fit into the budget
+// (one more order is reserved for synthesizing the best order after the search)
+static inline const char *kc_top_level_budget(kc_par *par, double timeStart, long long nTried, kc_gg *ggTemp, kc_vt *outs)
+{
+    double timeUsed = kc_wall_time() - timeStart;
+    if (par->time_limit > 0 && timeUsed + 2 * timeUsed / nTried > par->time_limit)
+        return "time limit";
+    size_t Mem = kc_gg_memory(ggTemp) + 8 * (size_t)outs->cap * outs->words;
+    if (par->mem_limit > 0 && 2 * Mem > ((size_t)par->mem_limit << 20))
+        return "memory limit";
+    return NULL;
+}
+
+// the output file of the input with the given extension (for example, "outputs/ex00.ckpt")
+static inline std::string kc_output_file_name(char *pInput, std::string Ext)
+{
+    std::string str(pInput);
+    str = str.substr(str.find_last_of("/") + 1);
+    return "./outputs/" + str.substr(0, str.find_last_of(".")) + Ext;
+}
+// the file with the best order of one slice of the orders (for example, "outputs/ex00.shard3of8")
+static inline std::string kc_shard_file_name(char *pInput, long long Id, long long Num)
+{
+    return kc_output_file_name(pInput, ".shard" + std::to_string(Id) + "of" + std::to_string(Num));
+}
+// records the number of orders, the slice tried, the number of orders tried, and the index and the cost of the best one
+static inline void kc_shard_write(kc_par *par, long long nTotal, long long First, long long Last, long long nTried, long long Best, long long Cost)
+{
+    if (Best >= 0)
+        printf("Slice %lld of %lld: tried %lld of the orders %lld-%lld.  The best order %lld has cost %d.\n",
+               par->shard_id, par->shard_num, nTried, First, Last - 1, Best, kc_cost_nodes(Cost));
+    else
+        printf("Slice %lld of %lld: there are no orders to try.\n", par->shard_id, par->shard_num);
+    FILE *pFile = fopen(par->shard_file, "wb");
+    if (pFile == NULL)
+    {
+        printf("Cannot open file \"%s\" for writing.\n", par->shard_file);
+        return;
+    }
+    fprintf(pFile, "%lld %lld %lld %lld %lld %lld\n", nTotal, First, Last, nTried, Best, Cost);
+    fclose(pFile);
+}
+// the key of the search: the truth tables in the initial order and the parameters changing the orders or their costs
+static inline kc_uint64 kc_ckpt_key(kc_vt *outs, kc_par *par)
+{
+    int i, Params[7] = {par->and_only, par->phase, par->top_k, par->delay, par->max_level, par->est_best, par->lib};
+    kc_uint64 Key = 0;
+    for (i = 0; i < outs->size; i++)
+        Key = (Key ^ kc_vt_hash(outs, i)) * 0x9E3779B97F4A7C15;
+    for (i = 0; i < 7; i++)
+        Key = (Key + Params[i]) * 0x9E3779B97F4A7C15, Key ^= Key >> 29;
+    return Key;
+}
+// saves the state of the search (the number of orders tried first, the next order to try, the number of orders tried,
+// and the best order so far) into a temporary file and renames it, so that the previous state is kept if the program
+// is stopped while writing
+static inline void kc_ckpt_write(kc_par *par, kc_uint64 Key, long long First, long long Last, long long nCands, long long Next,
+                                 long long nTried, long long Best, long long Cost, int *bestPerm, int nvars)
+{
+    std::string str = std::string(par->ckpt_file) + ".tmp";
+    FILE *pFile = fopen(str.c_str(), "wb");
+    if (pFile == NULL)
+    {
+        printf("Cannot open file \"%s\" for writing.\n", str.c_str());
+        return;
+    }
+    fprintf(pFile, "%llu %lld %lld %lld %lld %lld %lld %lld", (unsigned long long)Key, First, Last, nCands, Next, nTried, Best, Cost);
+    for (int k = 0; k < nvars; k++)
+        fprintf(pFile, " %d", bestPerm[k]);
+    fprintf(pFile, "\n");
+    fclose(pFile);
+    if (rename(str.c_str(), par->ckpt_file))
+        printf("Cannot rename file \"%s\" into \"%s\".\n", str.c_str(), par->ckpt_file);
+}
+// restores the state of the same search; returns 0 if there is no saved state or it belongs to another search
+// (nTotal is the number of the orders and oLast is the end of the range in the numbering of the loop)
+static inline int kc_ckpt_read(kc_par *par, kc_uint64 Key, long long First, long long Last, long long nTotal, long long oLast,
+                               long long *pnCands, long long *pNext, long long *pnTried, long long *pBest, long long *pCost,
+                               int *bestPerm, int nvars)
+{
+    FILE *pFile = fopen(par->ckpt_file, "rb");
+    if (pFile == NULL)
+    {
+        printf("There is no saved state in file \"%s\".  Starting the search from the beginning.\n", par->ckpt_file);
+        return 0;
+    }
+    unsigned long long KeyFile;
+    long long Range[2], State[5];
+    int k, Perm[MAX_VARS];
+    int nItems = fscanf(pFile, "%llu %lld %lld %lld %lld %lld %lld %lld", &KeyFile, Range, Range + 1, State, State + 1, State + 2, State + 3, State + 4);
+    for (k = 0; k < nvars && nItems == 8 + k; k++)
+        nItems += fscanf(pFile, "%d", Perm + k);
+    fclose(pFile);
+    if (nItems != 8 + nvars || KeyFile != Key || Range[0] != First || Range[1] != Last || Last > nTotal || State[1] >= oLast)
+    {
+        printf("File \"%s\" saves the state of another search.  Starting the search from the beginning.\n", par->ckpt_file);
+        return 0;
+    }
+    *pnCands = State[0], *pNext = State[1], *pnTried = State[2], *pBest = State[3], *pCost = State[4];
+    memcpy(bestPerm, Perm, sizeof(int) * nvars);
+    printf("Resuming the search after %lld tried orders.  Best cost = %d.\n", *pnTried, *pnTried ? kc_cost_nodes(*pCost) : 0);
+    return 1;
+}
+
+// finds the best order among the slices and selects it as the only order to try (returns 0 if a slice is missing)
+static inline int kc_shard_merge(char *pInput, kc_par *par)
+{
+    long long i, nTotal = -1, nTried = 0, Best = -1, CostBest = -1, Slice[6];
+    for (i = 0; i < par->merge; i++)
+    {
+        std::string str = kc_shard_file_name(pInput, i, par->merge);
+        FILE *pFile = fopen(str.c_str(), "rb");
+        if (pFile == NULL)
+        {
+            printf("Cannot open file \"%s\" for reading.\n", str.c_str());
+            return 0;
+        }
+        int nItems = fscanf(pFile, "%lld %lld %lld %lld %lld %lld", Slice, Slice + 1, Slice + 2, Slice + 3, Slice + 4, Slice + 5);
+        fclose(pFile);
+        if (nItems != 6 || (nTotal >= 0 && Slice[0] != nTotal) || Slice[1] != Slice[0] * i / par->merge || Slice[2] != Slice[0] * (i + 1) / par->merge)
+        {
+            printf("File \"%s\" does not describe slice %lld of %d of the same orders.\n", str.c_str(), i, par->merge);
+            return 0;
+        }
+        nTotal = Slice[0], nTried += Slice[3];
+        if (Slice[4] >= 0 && (Best < 0 || Slice[5] < CostBest))
+            Best = Slice[4], CostBest = Slice[5];
+    }
+    if (Best < 0)
+    {
+        printf("The slices contain no tried orders.\n");
+        return 0;
+    }
+    printf("Merged %d slices: tried %lld of %lld orders.  The best order %lld has cost %d.\n",
+           par->merge, nTried, nTotal, Best, kc_cost_nodes(CostBest));
+    par->shard_id = Best, par->shard_num = nTotal; // the slice of the best order only
+    return 1;
+}
+
+// solve the problem for all variable orders (pPerm receives the variable of outs at each position of the best order,
+// pPhase receives the variables complemented in outs); the orders differing only in symmetric variables are tried once;
+// if the time or memory limit is given, the most promising orders are tried first and the best order found is used;
+// if the orders are sliced, only the slice given by the parameters is tried, starting from its first order
+static inline void kc_top_level_call_perm(int nvars, kc_vt *outs, kc_par *par, int *pPerm, unsigned *pPhase)
+{
+    double timeStart = kc_wall_time(), timeReport = timeStart;
+    // group symmetric variables and place the variables of each class next to each other
+    int i, k, currPerm[MAX_VARS] = {0}, bestPerm[MAX_VARS] = {0}, Class[MAX_VARS], Pos[MAX_VARS];
+    int nClasses = kc_sym_classes(outs, nvars, par->phase, Class, pPhase);
+    long long nOrders = kc_sym_order_num(Class, nvars);
+    int *pCost = NULL, *pCostAny = NULL;
+    int fAnytime = (par->time_limit > 0 || par->mem_limit > 0) && nOrders > 2 && !par->shard_num;
+    if (((par->top_k > 0 && par->top_k < nOrders) || (par->est_best && nOrders > 1)) && nvars <= KC_EST_MAX_VARS)
+        pCost = kc_est_start(outs, nvars, !par->and_only);
+    else if (fAnytime && nvars <= KC_EST_MAX_VARS && nOrders <= KC_ANYTIME_RANK_MAX)
+        pCostAny = kc_est_start(outs, nvars, !par->and_only);
+    for (i = 0; i < nvars; i++)
+    {
+        Pos[i] = i;
+        for (k = i; k > 0 && Class[currPerm[k - 1]] > Class[i]; k--)
+            currPerm[k] = currPerm[k - 1];
+        currPerm[k] = i;
+    }
+    kc_vt_reorder(outs, Pos, currPerm, nvars);
+    // initialize permutation (variables of the same class are represented by the smallest one)
+    for (i = 0; i < nvars; i++)
+        currPerm[i] = Pos[i] = Class[currPerm[i]];
+    if (par->verbose && nClasses < nvars)
+    {
+        printf("Found %d classes of symmetric variables:", nClasses);
+        for (i = 0; i < nvars; i++)
+            if (Class[i] == i)
+            {
+                printf(" {");
+                for (k = i; k < nvars; k++)
+                    if (Class[k] == i)
+                        printf("%s%s%d", k == i ? "" : " ", ((*pPhase >> k) & 1) ? "~" : "", k);
+                printf("}");
+            }
+        printf(".  Trying %lld orders instead of %d.\n", nOrders, kc_factorial(nvars));
+    }
+    // try the orders with the smallest estimated cost only, or, in the anytime mode, try the promising orders first
+    std::vector<int> Cands;
+    int fRanked = pCost != NULL;
+    if (fRanked && par->top_k > 0)
+    {
+        kc_perm_rank(pCost, nvars, Class, currPerm, nOrders, par->top_k, Cands, par->cancel);
+        if (par->verbose)
+            printf("Ranked %lld orders by the estimated cost and selected %d of them.\n", nOrders, par->top_k);
+        free(pCost);
+    }
+    else if (fRanked) // the labels of the best order (symmetric variables have the same cost)
+    {
+        int Vars[MAX_VARS], Cost = kc_est_best(pCost, nvars, Vars);
+        for (k = 0; k < nvars; k++)
+            Cands.push_back(Class[Vars[k]]);
+        if (par->verbose)
+            printf("Found the order with the smallest estimated cost (%d) over %d subsets of variables.\n", Cost, 1 << nvars);
+        free(pCost);
+    }
+    else if (pCostAny) // all orders are ranked, and the best ones are tried before the others
+    {
+        kc_perm_rank(pCostAny, nvars, Class, currPerm, nOrders, kc_min((int)nOrders, KC_ANYTIME_TOP), Cands, par->cancel);
+        if (par->verbose)
+            printf("Ranked %lld orders by the estimated cost and trying %d of them first.\n", nOrders, (int)Cands.size() / nvars);
+        free(pCostAny);
+    }
+    else if (fAnytime) // too many orders to rank quickly: the orders by influence are tried first
+        kc_perm_seeds(outs, nvars, currPerm, Cands);
+    int nCands = (int)Cands.size() / nvars;
+    // the slice of the orders (or of the selected orders) tried by this run
+    long long nTotal = fRanked ? nCands : nOrders, First = 0, Last = nTotal;
+    if (par->shard_num > 0)
+        First = nTotal * par->shard_id / par->shard_num, Last = nTotal * (par->shard_id + 1) / par->shard_num;
+    memcpy(bestPerm, currPerm, sizeof(int) * nvars);
+    long long o = fRanked ? First - nCands : (nCands ? -nCands : First), oLast = fRanked ? Last - nCands : Last;
+    long long CostBest = 0x7FFFFFFFFFFFFFFF, BestIndex = -1;
+    int AndsBest = 0x7FFFFFFF; // not saved in the checkpoint (see below)
+    long long nTried = 0, nReport = par->shard_num ? Last - First : nOrders;
+    kc_uint64 Key = par->ckpt_file ? kc_ckpt_key(outs, par) : 0;
+    double timeSaved = timeStart;
+    long long nSaved = nCands;
+    if (par->ckpt_file && par->resume && kc_ckpt_read(par, Key, First, Last, nTotal, oLast, &nSaved, &o, &nTried, &BestIndex, &CostBest, bestPerm, nvars) &&
+        nSaved != nCands && !fRanked)
+    {
+        // the orders placing the inputs by their influence are tried first only with a limit, which may differ from the saved run
+        if (nSaved == 0) // they were not tried first, so they are not skipped among all orders
+            Cands.clear(), nCands = 0;
+        else if (o < 0) // the rest of them are tried among all orders
+            o = 0;
+    }
+    if (BestIndex >= 0) // the and-nodes of the saved order are not known, so it is kept on ties
+        AndsBest = 0;
+    if (!fRanked && o > 0) // jump to the first order of the slice or to the order saved before
+    {
+        kc_get_perm_by_index(Pos, nvars, o, currPerm);
+        kc_vt_reorder(outs, Pos, currPerm, nvars);
+    }
+    // go through permutations and find the best one
+    const char *pStop = NULL;
+    kc_gg *ggTemp = kc_gg_start(nvars, outs);
+    for (; o < oLast && !pStop; o++)
+    {
+        int *pOrder = o < 0 ? &Cands[(nCands + o) * nvars] : currPerm;
+        if (o < 0 || (o == 0 && nCands)) // move the variables of the truth tables into the positions of the order
+            kc_vt_reorder(outs, Pos, pOrder, nvars);
+        if (o < 0 || !kc_perm_is_cand(currPerm, Cands, nvars))
+        {
+            long long CostPrev = CostBest;
+            int AndsPrev = AndsBest;
+            int LevelThis, CostThis = kc_top_level_try_order(ggTemp, nvars, outs, par, pOrder, &LevelThis, &CostBest, &AndsBest, bestPerm);
+            if (CostBest < CostPrev || AndsBest < AndsPrev)
+                BestIndex = fRanked ? nCands + o : o;
+            if (par->verbose)
+            {
+                printf("%3lld :", nTried);
+                for (k = 0; k < nvars; k++)
+                    printf(" %d", pOrder[k]);
+                printf(" : cost = %3d", CostThis);
+                if (par->delay)
+                    printf(" : levels = %3d", LevelThis);
+                printf("\n");
+            }
+            nTried++;
+            if (par->time_limit > 0 || par->mem_limit > 0)
+            {
+                pStop = kc_top_level_budget(par, timeStart, nTried, ggTemp, outs);
+                if (!par->verbose && !par->quiet && kc_wall_time() - timeReport >= KC_PROGRESS_PERIOD)
+                {
+                    timeReport = kc_wall_time();
+                    printf("Tried %lld of %lld orders (%5.1f %%).  Best cost = %d.  Time =%6.2f sec\n",
+                           nTried, nReport, 100.0 * nTried / nReport, kc_cost_nodes(CostBest), timeReport - timeStart);
+                    fflush(stdout);
+                }
+            }
+            if (par->cancel && *par->cancel)
+                pStop = "deadline";
+        }
+        if (o >= 0)
+        {
+            kc_get_next_perm(currPerm, nvars, outs);
+            memcpy(Pos, currPerm, sizeof(int) * nvars);
+        }
+        if (par->ckpt_file && kc_wall_time() - timeSaved >= KC_CHECKPOINT_PERIOD)
+        {
+            kc_ckpt_write(par, Key, First, Last, nCands, o + 1, nTried, BestIndex, CostBest, bestPerm, nvars);
+            timeSaved = kc_wall_time();
+        }
+    }
+    kc_gg_stop(ggTemp);
+    if (o >= oLast) // the limit was reached at the last order, so the search is complete
+        pStop = NULL;
+    if (par->ckpt_file && pStop) // keep the state to try the remaining orders later
+        kc_ckpt_write(par, Key, First, Last, nCands, o, nTried, BestIndex, CostBest, bestPerm, nvars);
+    else if (par->ckpt_file) // the search is complete
+        remove(par->ckpt_file);
+    if (pStop && !par->quiet)
+        printf("Stopped trying variable orders at the %s after %lld of %lld orders.  Best cost = %d.\n",
+               pStop, nTried, nReport, kc_cost_nodes(CostBest));
+    if (par->shard_file)
+        kc_shard_write(par, nTotal, First, Last, nTried, BestIndex, BestIndex < 0 ? -1 : CostBest);
+    // assign the variables of each class to the positions labeled by the class
+    kc_perm_vars(bestPerm, Class, nvars, pPerm);
+    // update the truth table according to the best permutation
+    kc_vt_reorder(outs, Pos, bestPerm, nvars);
+}
+
+// replaces the result by the circuit of the best fixed-polarity Reed-Muller form of the outputs if it is smaller
+static inline kc_gg *kc_top_level_fprm(kc_gg *gg, kc_par *par)
+{
+    unsigned Polarity;
+    int nvars = gg->nins, nNodes = kc_gg_node_count(gg);
+    if (par->and_only && par->format && strcmp(par->format, "aig")) // the netlist would keep the xor-gates of the form
+        return gg;
+    int nTerms = kc_rm_best_polarity(&gg->outs, nvars, &Polarity);
+    int nNodesRm = kc_rm_node_num(&gg->outs, nvars, Polarity);
+    if (par->verbose)
+        printf("The best fixed-polarity Reed-Muller form has %d terms (polarity %0*X) and needs %d nodes instead of %d.\n",
+               nTerms, (nvars + 3) / 4, Polarity, nNodesRm, nNodes);
+    if (nNodesRm >= nNodes)
+        return gg;
+    kc_gg *ggRm = kc_rm_build(&gg->outs, nvars, Polarity);
+    ggRm->delay = par->delay, ggRm->max_level = par->max_level;
+    int nNodesNew = kc_gg_node_count(ggRm);
+    int fWorse = kc_gg_cost(ggRm, kc_gg_level(ggRm), nNodesNew) >= kc_gg_cost(gg, kc_gg_level(gg), nNodes);
+    if (!fWorse && par->and_only) // the xor-gates of the form are compared by the and-nodes written for them
+    {
+        std::vector<int> Objs, Outs;
+        int nAnds = kc_gg_aiger_expand(gg, Objs, Outs);
+        fWorse = kc_gg_aiger_expand(ggRm, Objs, Outs) >= nAnds;
+    }
+    if (fWorse)
+    {
+        kc_gg_stop(ggRm);
+        return gg;
+    }
+    if (par->verbose)
+        printf("Using the circuit of the Reed-Muller form with %d nodes.\n", nNodesNew);
+    memcpy(ggRm->perm, gg->perm, sizeof(int) * nvars), ggRm->phase = gg->phase;
+    kc_gg_stop(gg);
+    return ggRm;
+}
+
+// solve the problem for the best variable order (if requested) or for the given one
+static inline kc_gg *kc_top_level_solve(int nvars, kc_vt *outs, kc_par *par)
+{
+    int Perm[MAX_VARS];
+    unsigned Phase = 0;
+    kc_par ParOne = *par;
+    if (par->try_perm && (par->est_best || par->top_k > 0) && nvars > KC_EST_MAX_VARS) // avoid trying all orders instead
+    {
+        printf("The variable orders of more than %d inputs are not ranked by the estimated cost (-e, -K).  Using the given order.\n", KC_EST_MAX_VARS);
+        ParOne.try_perm = 0;
+        par = &ParOne;
+    }
+    if (par->try_perm)
+        kc_top_level_call_perm(nvars, outs, par, Perm, &Phase);
+    kc_gg *gg = kc_top_level_call_one(nvars, outs, par);
+    if (par->try_perm)
+        memcpy(gg->perm, Perm, sizeof(int) * nvars), gg->phase = Phase;
+    if (par->fprm)
+        gg = kc_top_level_fprm(gg, par);
+    return gg;
+}
+
+// dump the result of solving the problem into a file (for example, "stats.txt")
+static inline void kc_top_level_stats(char *pInput, int nvars, int nouts, int Cost)
+{
+    char *pDumpFile = (char *)"stats.txt";
+    FILE *pFile = fopen(pDumpFile, "a+");
+    if (pFile == NULL)
+    {
+        printf("Cannot open file \"%s\" for reading.\n", pDumpFile);
+        return;
+    }
+    fprintf(pFile, "%s %d %d %d\n", pInput, nvars, nouts, Cost);
+    fclose(pFile);
+    printf("Added statistics for \"%s\" to the file \"%s\".\n", pInput, pDumpFile);
+}
+
+// writes the result in the selected format and adds its statistics to the file
+static inline void kc_top_level_write(char *input, kc_gg *gg, kc_par *par, int nvars)
+{
+    std::string str(input);
+    size_t found = (str.find_last_of("/"));
+    str = (str.substr(found+1, 4));
+    
+    kc_gg *ggOut = par->rewrite ? kc_gg_rewrite(gg, 1) : gg;
+    if (par->format && strcmp(par->format, "aig")) // the netlist with xor-gates
+        kc_gg_netlist_write((char *)(str + "." + par->format).c_str(), ggOut, 1);
+    else
+        kc_gg_aiger_write((char *)(str + ".aig").c_str(), ggOut, 1);
+    int Cost = kc_gg_node_count(ggOut); // the and-nodes of the rewritten AIG
+    if (ggOut != gg)
+        kc_gg_stop(ggOut);
+    str = str + "." + (par->format ? par->format : "aig");
+    kc_top_level_stats((char *)str.c_str(), nvars, kc_gg_po_num(gg), Cost);
+}
+
+extern "C"
+{
+
+    // solving one instance of a problem with the given parameters
+    int kc_top_level_call_par(char *input, kc_par *par)
+    {
+        clock_t clkStart = clock();
+        kc_vt Outs, *outs = &Outs;
+        int verbose = par->verbose;
+        kc_par ParSlice = *par;
+        std::string shard, ckpt;
+        if (par->merge && !kc_shard_merge(input, &ParSlice))
+            return 0;
+        if (!par->merge && par->shard_num > 0)
+            shard = kc_shard_file_name(input, par->shard_id, par->shard_num), ParSlice.shard_file = shard.c_str();
+        if (!par->merge && par->try_perm) // the state of a long search is saved periodically
+        {
+            ckpt = par->shard_num > 0 ? shard + ".ckpt" : kc_output_file_name(input, ".ckpt");
+            ParSlice.ckpt_file = ckpt.c_str();
+        }
+        int nvars = kc_read_input_data(input, outs);
+        if (nvars == 0)
+            return 0;
+        assert(nvars <= MAX_VARS);
+        kc_gg *gg = kc_top_level_solve(nvars, outs, &ParSlice);
+        kc_gg_print(gg, verbose);
+        if (par->verify == 0)
+            kc_gg_verify(gg);
+        else if (kc_top_level_verify(gg, par, 0))
+            printf("Verification by simulation failed.\n");
+        else
+            printf("Verification by simulation succeeded.  ");
+        printf("Time =%6.2f sec\n", (float)(clock() - clkStart) / CLOCKS_PER_SEC);
+        kc_top_level_write(input, gg, par, nvars);
+        kc_gg_stop(gg);
+        kc_vt_stop(outs);
+        return 1;
+    }
+
+    // solving one instance of a problem by reading the outputs in chunks and synthesizing them into one graph
+    // (only the truth tables of the current chunk are kept; each output is verified after it is synthesized)
+    int kc_top_level_stream(char *input, kc_par *par)
+    {
+        clock_t clkStart = clock();
+        kc_stream Stream, *p = &Stream;
+        int n, nvars = kc_stream_start(p, input), nOuts = 0, nFailed = 0;
+        if (nvars == 0)
+            return 0;
+        if (par->try_perm || par->fprm)
+            printf("Trying variable orders and Reed-Muller forms needs all outputs and is not done for the chunks.\n");
+        kc_vt Empty;
+        kc_vt_start(&Empty, 0, kc_truth_word_num(nvars));
+        kc_gg *gg = kc_gg_start(nvars, &Empty);
+        kc_vt_stop(&Empty);
+        size_t MemPeak = 0;
+        while ((n = kc_stream_read(p, &gg->outs, par->chunk)) > 0)
+        {
+            int nTops = kc_vi_size(&gg->tops);
+            kc_top_level_synth(gg, par);
+            nFailed += kc_top_level_verify(gg, par, nTops); // before the truth tables of the chunk are dropped
+            MemPeak = kc_max(MemPeak, kc_gg_memory(gg));
+            nOuts += n;
+            if (par->verbose)
+                printf("Synthesized outputs %d-%d.  Nodes = %d.  Memory = %.2f MB.\n", nOuts - n, nOuts - 1, gg->size - 1 - nvars, kc_gg_memory(gg) / (1024.0 * 1024.0));
+        }
+        kc_vt_resize(&gg->outs, 0); // the truth tables of the last chunk
+        kc_stream_stop(p);
+        if (n < 0)
+        {
+            kc_gg_stop(gg);
+            return 0;
+        }
+        printf("Finished synthesizing %d-input %d-output function from file \"%s\" in chunks of %d outputs.  Peak memory = %.2f MB.\n",
+               nvars, nOuts, input, par->chunk, MemPeak / (1024.0 * 1024.0));
+        kc_gg_print(gg, par->verbose);
+        if (nFailed)
+            printf("Verification%s failed for %d outputs.  ", par->verify ? " by simulation" : "", nFailed);
+        else
+            printf("Verification%s succeeded.  ", par->verify ? " by simulation" : "");
+        printf("Time =%6.2f sec\n", (float)(clock() - clkStart) / CLOCKS_PER_SEC);
+        kc_top_level_write(input, gg, par, nvars);
+        kc_gg_stop(gg);
+        return 1;
+    }
+
+    // solving one instance of a problem
+    int kc_top_level_call(char *input, int try_perm, int and_only, int verbose)
+    {
+        kc_par Par, *par = &Par;
+        kc_par_default(par);
+        par->try_perm = try_perm;
+        par->and_only = and_only;
+        par->verbose = verbose;
+        return kc_top_level_call_par(input, par);
+    }
+
+    // converting the input into the binary truth-table file (for example, "inputs/ex00.truth" into "inputs/ex00.ttb")
+    int kc_top_level_convert(char *input)
+    {
+        kc_vt Outs, *outs = &Outs;
+        int nvars = kc_read_input_data(input, outs);
+        if (nvars == 0)
+            return 0;
+        std::string str(input);
+        size_t found = str.find_last_of(".");
+        if (found != std::string::npos && (str.find_last_of("/") == std::string::npos || found > str.find_last_of("/")))
+            str = str.substr(0, found);
+        str = str + ".ttb";
+        int Res = kc_write_ttb((char *)str.c_str(), nvars, outs);
+        if (Res)
+            printf("Written %d-input %d-output function into binary truth-table file \"%s\".\n", nvars, outs->size, str.c_str());
+        kc_vt_stop(outs);
+        return Res;
+    }
+
+    // collecting all problems in the list into one archive (for example, "ex.filelist" into "ex.kca")
+    int kc_top_level_convert_list(char *pInput)
+    {
+        FILE *pFile = fopen(pInput, "rb");
+        if (pFile == NULL)
+        {
+            printf("Cannot open file \"%s\" for reading.\n", pInput);
+            return 0;
+        }
+        std::string str(pInput);
+        str = str.substr(0, str.find_last_of(".")) + ".kca";
+        FILE *pArc = kc_arc_start(str.c_str());
+        if (pArc == NULL)
+        {
+            fclose(pFile);
+            return 0;
+        }
+        std::vector<kc_arc_entry> entries;
+        char Buffer[1000];
+        while (fscanf(pFile, "%s", Buffer) == 1)
+        {
+            kc_vt Outs, *outs = &Outs;
+            int nvars = kc_read_input_data(Buffer, outs);
+            if (nvars == 0)
+                continue;
+            std::string name(Buffer);
+            name = name.substr(name.find_last_of("/") + 1);
+            name = name.substr(0, name.find_last_of("."));
+            long long offset = ftell(pArc);
+            fwrite(kc_vt_array(outs), 8, outs->size * outs->words, pArc);
+            kc_arc_add(pArc, entries, offset, name.c_str(), nvars, outs->size, -1);
+            kc_vt_stop(outs);
+        }
+        fclose(pFile);
+        kc_arc_stop(pArc, KC_ARC_TRUTHS, entries);
+        printf("Written %d problems from the list \"%s\" into archive \"%s\".\n", (int)entries.size(), pInput, str.c_str());
+        return 1;
+    }
+
+    // solving all problems in the archive (or only the one with the given index if probId >= 0);
+    // the resulting AIGs and their statistics are written into one archive in the output directory
+    int kc_top_level_archive(char *pInput, int probId, kc_par *par)
+    {
+        clock_t clkStart = clock();
+        kc_arc_header h;
+        FILE *pFile = kc_arc_open(pInput, &h);
+        if (pFile == NULL)
+            return 0;
+        if (h.kind != KC_ARC_TRUTHS || probId >= h.nitems)
+        {
+            printf("The archive \"%s\" does not contain problem %d.\n", pInput, probId < 0 ? 0 : probId);
+            fclose(pFile);
+            return 0;
+        }
+        std::string str(pInput);
+        str = str.substr(str.find_last_of("/") + 1);
+        str = "./outputs/" + str.substr(0, str.find_last_of(".")) + ".aigs.kca";
+        FILE *pArc = kc_arc_start(str.c_str());
+        if (pArc == NULL)
+        {
+            fclose(pFile);
+            return 0;
+        }
+        std::vector<kc_arc_entry> entries;
+        int i, nFailed = 0;
+        for (i = probId < 0 ? 0 : probId; i < (probId < 0 ? h.nitems : probId + 1); i++)
+        {
+            kc_arc_entry e;
+            kc_vt Outs, *outs = &Outs;
+            int nvars = kc_arc_read_entry(pFile, &h, i, &e) ? kc_arc_read_truths(pFile, &e, outs) : 0;
+            if (nvars == 0)
+                continue;
+            kc_gg *gg = kc_top_level_solve(nvars, outs, par);
+            int Cost = kc_gg_node_count(gg);
+            int fFailed = kc_top_level_verify(gg, par, 0) > 0;
+            long long offset = ftell(pArc);
+            if (par->rewrite)
+            {
+                kc_gg *ggAnd = kc_gg_rewrite(gg, par->verbose);
+                kc_gg_aiger_write_file(pArc, ggAnd);
+                Cost = kc_gg_node_count(ggAnd); // the and-nodes of the AIG written into the archive
+                kc_gg_stop(ggAnd);
+            }
+            else
+                kc_gg_aiger_write_file(pArc, gg);
+            kc_arc_add(pArc, entries, offset, e.name, nvars, outs->size, Cost);
+            if (par->verbose || fFailed)
+                printf("Problem %d \"%s\" : %d inputs, %d outputs, %d nodes.%s\n", i, e.name, nvars, outs->size, Cost,
+                       fFailed ? "  Verification FAILED." : "");
+            nFailed += fFailed;
+            kc_gg_stop(gg);
+            kc_vt_stop(outs);
+        }
+        fclose(pFile);
+        kc_arc_stop(pArc, KC_ARC_AIGS, entries);
+        printf("Finished solving %d problems from archive \"%s\" (verification %s).  Time =%6.2f sec\n",
+               (int)entries.size(), pInput, nFailed ? "FAILED" : "succeeded", (float)(clock() - clkStart) / CLOCKS_PER_SEC);
+        printf("Written the resulting AIGs and their statistics into archive \"%s\".\n", str.c_str());
+        return nFailed == 0;
+    }
+
+    // solving all problems in the list
+    int kc_top_level_list(char *pInput, kc_par *par)
+    {
+        FILE *pFile = fopen(pInput, "rb");
+        if (pFile == NULL)
+        {
+            printf("Cannot open file \"%s\" for reading.\n", pInput);
+            return 0;
+        }
+        char Buffer[1000];
+        int nProbs = 0;
+        while (fscanf(pFile, "%s", Buffer) == 1)
+        {
+            printf("\nSolving problem \"%s\".\n", Buffer);
+            kc_top_level_call_par(Buffer, par), nProbs++;
+        }
+        fclose(pFile);
+        printf("\nFinished solving %d problems from the list \"%s\".\n", nProbs, pInput);
+        return 1;
+    }
 }
 
 /*************************************************************
-                  Reading input data
+              Portfolio of synthesis strategies
 **************************************************************/
 
-static inline int kc_log2(unsigned n)
+#define KC_PORTFOLIO_TIME 60.0 // the default deadline of the portfolio (in seconds)
+#define KC_PORTFOLIO_TOP_K 32  // the number of orders with the smallest estimated cost tried by the portfolio
+
+// the strategy run by one thread of the portfolio
+typedef struct kc_strategy_
 {
-    int r;
-    if (n < 2)
-        return (int)n;
-    for (r = 0, n--; n; n >>= 1, r++)
+    const char *name; // the name printed in the statistics
+    int and_only;     // uses only and-gates
+    int try_perm;     // tries variable orders (all orders until the deadline unless the next fields select some)
+    int est_best;     // tries the order with the smallest estimated cost
+    int top_k;        // tries the given number of orders with the smallest estimated cost
+} kc_strategy;
+
+static const kc_strategy s_Strategies[] = {
+    {"xor", 0, 0, 0, 0},
+    {"and", 1, 0, 0, 0},
+    {"xor-est", 0, 1, 1, 0},
+    {"xor-top", 0, 1, 0, KC_PORTFOLIO_TOP_K},
+    {"xor-all", 0, 1, 0, 0},
+    {"and-all", 1, 1, 0, 0}};
+#define KC_STRATEGY_NUM ((int)(sizeof(s_Strategies) / sizeof(s_Strategies[0])))
+
+// the result of one strategy
+typedef struct kc_portfolio_res_
+{
+    kc_gg *gg;      // the graph (NULL if the synthesis was cancelled)
+    long long cost; // the number of and-nodes (or the levels and the nodes in the delay mode)
+    double time;    // the wall-clock time in seconds
+} kc_portfolio_res;
+
+// runs the strategy on its own copy of the truth tables and lowers the bound shared by the threads
+static void kc_portfolio_thread(int nvars, kc_vt *outs, kc_par par, kc_portfolio_res *pRes, std::atomic<int> *pnDone, std::atomic<int> *pnFound)
+{
+    double timeStart = kc_wall_time();
+    kc_vt Outs;
+    kc_vt_dup(&Outs, outs);
+    kc_gg *gg = kc_top_level_solve(nvars, &Outs, &par);
+    kc_vt_stop(&Outs);
+    pRes->time = kc_wall_time() - timeStart;
+    if (kc_gg_po_num(gg) < kc_vt_size(&gg->outs)) // the synthesis is cancelled or stopped by the bound
     {
-    };
-    return r;
+        kc_gg_stop(gg);
+        pRes->gg = NULL;
+        (*pnDone)++;
+        return;
+    }
+    std::vector<int> Objs, Lits;
+    int nAnds = kc_gg_aiger_expand(gg, Objs, Lits);
+    pRes->gg = gg;
+    pRes->cost = par.delay ? kc_gg_cost(gg, kc_gg_level(gg), kc_gg_node_count(gg)) : nAnds;
+    for (long long Bound = par.bound ? par.bound->load() : 0; par.bound && nAnds < Bound;)
+        par.bound->compare_exchange_weak(Bound, nAnds);
+    (*pnFound)++, (*pnDone)++;
 }
-static inline int kc_hex_to_int(char c)
+
+extern "C"
 {
-    int Digit = 0;
-    if (c >= '0' && c <= '9')
-        Digit = c - '0';
-    else if (c >= 'A' && c <= 'F')
-        Digit = c - 'A' + 10;
-    else if (c >= 'a' && c <= 'f')
-        Digit = c - 'a' + 10;
-    else
-        assert(0);
-    assert(Digit >= 0 && Digit < 16);
-    return Digit;
+    // solving one instance of a problem by running the strategies in parallel until the deadline and keeping
+    // the best result; the graphs of the strategies that cannot improve the best result so far are abandoned
+    int kc_top_level_portfolio(char *input, kc_par *par)
+    {
+        double timeStart = kc_wall_time();
+        kc_vt Outs, *outs = &Outs;
+        int i, nvars = kc_read_input_data(input, outs), iBest = -1;
+        if (nvars == 0)
+            return 0;
+        if (par->lib) // the library is shared by the threads
+            kc_lib_prepare();
+        std::atomic<long long> Bound(0x7FFFFFFFFFFFFFFF);
+        std::atomic<int> Cancel(0), nDone(0), nFound(0);
+        kc_par Base = *par;
+        Base.verbose = 0, Base.quiet = 1, Base.try_perm = 0, Base.and_only = 0;
+        Base.est_best = Base.top_k = 0, Base.shard_num = Base.merge = 0;
+        Base.shard_file = Base.ckpt_file = NULL;
+        double Deadline = par->time_limit > 0 ? par->time_limit : KC_PORTFOLIO_TIME;
+        Base.time_limit = 0.9 * Deadline; // leave time for synthesizing the best orders
+        Base.bound = par->delay ? NULL : &Bound; // the levels are not bounded
+        Base.cancel = &Cancel;
+        std::vector<kc_portfolio_res> Res(KC_STRATEGY_NUM);
+        std::vector<std::thread> Threads;
+        for (i = 0; i < KC_STRATEGY_NUM; i++)
+        {
+            const kc_strategy *s = &s_Strategies[i];
+            Res[i].gg = NULL;
+            if ((s->est_best || s->top_k) && nvars > KC_EST_MAX_VARS) // the orders are not ranked
+                continue;
+            kc_par ParS = Base;
+            ParS.and_only = s->and_only, ParS.try_perm = s->try_perm, ParS.est_best = s->est_best, ParS.top_k = s->top_k;
+            Threads.push_back(std::thread(kc_portfolio_thread, nvars, outs, ParS, &Res[i], &nDone, &nFound));
+        }
+        // after the deadline, stop the strategies as soon as one of them has a result
+        while (nDone < (int)Threads.size())
+        {
+            if (!Cancel && nFound > 0 && kc_wall_time() - timeStart > Deadline)
+                Cancel = 1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        for (i = 0; i < (int)Threads.size(); i++)
+            Threads[i].join();
+        for (i = 0; i < KC_STRATEGY_NUM; i++)
+        {
+            if (Res[i].gg == NULL)
+                continue;
+            if (iBest < 0 || Res[i].cost < Res[iBest].cost)
+                iBest = i;
+            printf("Strategy %-8s: %s = %6d.  Time =%6.2f sec\n", s_Strategies[i].name, par->delay ? "nodes" : "and-nodes",
+                   kc_cost_nodes(Res[i].cost), Res[i].time);
+        }
+        assert(iBest >= 0); // the first finished strategy is not cancelled
+        printf("The best result is found by strategy \"%s\" (%d of %d strategies were cancelled or skipped).\n",
+               s_Strategies[iBest].name, KC_STRATEGY_NUM - nFound, KC_STRATEGY_NUM);
+        for (i = 0; i < KC_STRATEGY_NUM; i++)
+            if (i != iBest)
+                kc_gg_stop(Res[i].gg);
+        kc_gg *gg = Res[iBest].gg;
+        kc_gg_print(gg, par->verbose);
+        int nFailed = kc_top_level_verify(gg, par, 0);
+        if (nFailed)
+            printf("Verification%s failed for %d outputs.  ", par->verify ? " by simulation" : "", nFailed);
+        else
+            printf("Verification%s succeeded.  ", par->verify ? " by simulation" : "");
+        printf("Time =%6.2f sec\n", kc_wall_time() - timeStart);
+        if (nFailed == 0) // the result is not written if it is wrong
+            kc_top_level_write(input, gg, par, nvars);
+        kc_gg_stop(gg);
+        kc_vt_stop(outs);
+        return nFailed == 0;
+    }
 }
-static inline kc_uint64 kc_truth_stretch(kc_uint64 t, int nVars)
+
+/*************************************************************
+                    Synthesis server
+**************************************************************/
+
+// the state kept between the requests: the graph, the truth tables, and the cache of results
+typedef struct kc_server_
 {
-    assert(nVars >= 0);
-    if (nVars == 0)
-        nVars++, t = (t & 0x1) | ((t & 0x1) << 1);
-    if (nVars == 1)
-        nVars++, t = (t & 0x3) | ((t & 0x3) << 2);
-    if (nVars == 2)
-        nVars++, t = (t & 0xF) | ((t & 0xF) << 4);
-    if (nVars == 3)
-        nVars++, t = (t & 0xFF) | ((t & 0xFF) << 8);
-    if (nVars == 4)
-        nVars++, t = (t & 0xFFFF) | ((t & 0xFFFF) << 16);
-    if (nVars == 5)
-        nVars++, t = (t & 0xFFFFFFFF) | ((t & 0xFFFFFFFF) << 32);
-    assert(nVars == 6);
-    return t;
-}
+    kc_gg *gg;                                          // the graph reused by all requests
+    kc_vt outs;                                         // the truth tables of the current request
+    std::unordered_map<std::string, std::string> cache; // the AIGER files of the solved requests
+    int nreqs;                                          // the number of requests
+    int nhits;                                          // the number of requests served from the cache
+    int verbose;                                        // enables printing the requests into stderr
+} kc_server;
 
-static inline int kc_read_line(kc_vt *outs, kc_vi *chars, int nVars)
+#define KC_SERVER_CACHE (1 << 16) // the largest number of results kept in the cache
+
+// solves one request "[-p] [-a] <hex> [<hex> ...]" (one truth table per output); res is the AIGER file or the error message
+static inline int kc_server_solve(kc_server *p, std::vector<std::string> &tokens, std::string &res)
 {
-    int i, entry;
-    assert(chars->size > 0);
-    if (nVars == 0)
+    int i, try_perm = 0, and_only = 0, nvars = 0, nChars = 0, nOuts = 0;
+    std::string key;
+    for (size_t t = 0; t < tokens.size(); t++)
     {
-        nVars = kc_log2(chars->size);
-        kc_vt_start(outs, 0, kc_truth_word_num(nVars));
+        if (tokens[t] == "-p")
+            try_perm ^= 1;
+        else if (tokens[t] == "-a")
+            and_only ^= 1;
+        else if (tokens[t][0] == '-')
+            return res = "unknown option " + tokens[t], 0;
+        else
+        {
+            if (tokens[t].find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+                return res = "the truth table is not in hex notation", 0;
+            if (nOuts++ == 0)
+                nChars = (int)tokens[t].size(), nvars = kc_log2(4 * nChars);
+            if ((int)tokens[t].size() != nChars || (1 << nvars) != 4 * nChars || nvars > MAX_VARS)
+                return res = "the truth tables should have the same size of 2^k bits (k <= 16)", 0;
+            key += " " + tokens[t];
+        }
     }
-    assert(nVars == kc_log2(chars->size));
-    if ((1 << nVars) != chars->size)
+    if (nOuts == 0)
+        return res = "no truth tables are given", 0;
+    key = (try_perm ? "p" : "") + std::string(and_only ? "a" : "") + key;
+    std::unordered_map<std::string, std::string>::iterator it = p->cache.find(key);
+    if (it != p->cache.end())
     {
-        printf("The input string length (%d chars) does not match the size (%d bits) of the truth table of %d-var function.\n",
-               chars->size, 1 << nVars, nVars);
-        kc_vt_stop(outs);
-        kc_vi_stop(chars);
-        return 0;
+        p->nhits++;
+        res = it->second;
+        return 1;
     }
-    kc_uint64 *tt = kc_vt_append(outs);
-    memset(tt, 0, 8 * outs->words);
-    kc_vi_for_each_entry(chars, entry, i) if (entry == (int)'1')
-        tt[(chars->size - 1 - i) >> 6] |= ((kc_uint64)1) << ((chars->size - 1 - i) & 63);
-    if (nVars < 6)
-        tt[0] = kc_truth_stretch(tt[0], nVars);
-    kc_vi_resize(chars, 0);
-    return nVars;
+    kc_vt_restart(&p->outs, nOuts, kc_truth_word_num(nvars));
+    for (size_t t = 0; t < tokens.size(); t++)
+        if (tokens[t][0] != '-')
+            kc_read_hex(tokens[t].c_str(), nChars, nvars, &p->outs);
+    kc_par Par, *par = &Par;
+    kc_par_default(par);
+    par->and_only = and_only;
+    int Perm[MAX_VARS];
+    unsigned Phase = 0;
+    if (try_perm)
+        kc_top_level_call_perm(nvars, &p->outs, par, Perm, &Phase);
+    if (p->gg == NULL)
+        p->gg = kc_gg_start(nvars, &p->outs);
+    else
+        kc_gg_restart(p->gg, nvars, &p->outs);
+    kc_top_level_synth(p->gg, par);
+    for (i = 0; try_perm && i < nvars; i++)
+        p->gg->perm[i] = Perm[i];
+    p->gg->phase = Phase;
+    if (kc_gg_verify_quiet(p->gg))
+        return res = "verification failed", 0;
+    res.clear();
+    kc_gg_aiger_write_str(res, p->gg);
+    if (p->cache.size() >= KC_SERVER_CACHE)
+        p->cache.clear();
+    p->cache[key] = res;
+    return 1;
 }
-static inline int kc_read_file(FILE *pFile, kc_vt *outs)
+// serves the requests coming one per line; each response is "aig <bytes>" followed by the AIGER file
+// or "error <message>"; returns 1 if the server should continue after the end of the stream
+static inline int kc_server_serve(kc_server *p, FILE *pIn, FILE *pOut)
 {
-    kc_vi Chars, *chars = &Chars;
-    kc_vi_start(chars, 1000);
-    int c, nVars = 0;
-    while ((c = fgetc(pFile)) != EOF)
+    std::string line, res;
+    std::vector<std::string> tokens;
+    while (kc_read_text_line(pIn, line))
     {
-        if (c == '\r' || c == '\t' || c == ' ')
+        kc_split_line(line, tokens);
+        if (tokens.empty())
             continue;
-        if (c != '\n')
-            kc_vi_push(chars, c);
-        else if (chars->size && (nVars = kc_read_line(outs, chars, nVars)) == 0)
+        if (tokens[0] == "quit")
+            return 1;
+        if (tokens[0] == "shutdown")
             return 0;
+        p->nreqs++;
+        if (p->verbose)
+            fprintf(stderr, "Request %d : %s\n", p->nreqs, line.c_str());
+        if (kc_server_solve(p, tokens, res))
+            fprintf(pOut, "aig %d\n", (int)res.size()), fwrite(res.data(), 1, res.size(), pOut);
+        else
+            fprintf(pOut, "error %s\n", res.c_str());
+        if (fflush(pOut) || ferror(pOut)) // the client is gone (for example, EPIPE); drop the connection
+        {
+            fprintf(stderr, "Cannot send the response to request %d.  Closing the connection.\n", p->nreqs);
+            return 1;
+        }
     }
-    if (chars->size && (nVars = kc_read_line(outs, chars, nVars)) == 0)
-        return 0;
-    kc_vi_stop(chars);
-    return nVars;
+    return 1;
 }
-static inline int kc_read_input_data(char *pInput, kc_vt *outs)
+// accepts connections on the Unix domain socket and serves them one at a time
+static inline int kc_server_socket(kc_server *p, char *pPath)
 {
-    if (strstr(pInput, "."))
-    { // pInput is a file name
-        FILE *pFile = fopen(pInput, "rb");
-        if (pFile == NULL)
-        {
-            printf("Cannot open file \"%s\" for reading.\n", pInput);
-            return 0;
-        }
-        int nVars = kc_read_file(pFile, outs);
-        // kc_vt_print2_all( outs );
-        printf("Finished entring %d-input %d-output function from file \"%s\".\n", nVars, outs->size, pInput);
-        fclose(pFile);
-        return nVars;
+#ifndef _WIN32
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (fd < 0 || strlen(pPath) >= sizeof(addr.sun_path))
+    {
+        printf("Cannot create socket \"%s\".\n", pPath);
+        return 0;
     }
-    else
-    { // pInput is a truth table
-        kc_uint64 *tt, Num = 0;
-        int i;
-        int nChars = strlen(pInput);
-        int nVars = kc_log2(4 * nChars);
-        if ((1 << nVars) != 4 * nChars)
+    strcpy(addr.sun_path, pPath);
+    unlink(pPath);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0)
+    {
+        printf("Cannot listen on socket \"%s\".\n", pPath);
+        close(fd);
+        return 0;
+    }
+    // a client closing the connection before reading its response should not stop the server
+    signal(SIGPIPE, SIG_IGN);
+    printf("Listening on socket \"%s\".\n", pPath);
+    fflush(stdout);
+    int fContinue = 1;
+    while (fContinue)
+    {
+        int conn = accept(fd, NULL, NULL);
+        if (conn < 0 && (errno == EINTR || errno == ECONNABORTED))
+            continue;
+        if (conn < 0 && (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM))
         {
-            printf("The input string length (%d chars) does not match the size (%d bits) of the truth table of %d-var function.\n",
-                   nChars, 1 << nVars, nVars);
-            return 0;
+            // out of descriptors or memory for now; wait for the connections being closed
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
         }
-        kc_vt_start(outs, 1, kc_truth_word_num(nVars));
-        tt = kc_vt_append(outs);
-        for (i = nChars - 1; i >= 0; i--)
+        if (conn < 0)
         {
-            Num |= (kc_uint64)kc_hex_to_int(pInput[nChars - 1 - i]) << ((i & 0xF) * 4);
-            if ((i & 0xF) == 0)
-                tt[i >> 4] = Num, Num = 0;
+            printf("Cannot accept connections on socket \"%s\" (%s).\n", pPath, strerror(errno));
+            fContinue = -1;
+            break;
         }
-        if (nVars < 6)
-            tt[0] = kc_truth_stretch(tt[0], nVars);
-        kc_vt_print_all(outs);
-        printf("Finished entring %d-input %d-output function.\n", nVars, 1);
-        return nVars;
+        FILE *pIn = fdopen(conn, "r");
+        FILE *pOut = fdopen(dup(conn), "w");
+        fContinue = kc_server_serve(p, pIn, pOut);
+        fclose(pOut);
+        fclose(pIn);
     }
+    close(fd);
+    unlink(pPath);
+    return fContinue >= 0;
+#else
+    printf("Unix domain sockets are not supported on this platform.\n");
+    return 0;
+#endif
 }
 
-/*************************************************************
-                  Top level procedures
-**************************************************************/
-
-// solve the problem for one variable order
-static inline kc_gg *kc_top_level_call_one(int nvars, kc_vt *outs, int and_only, int verbose)
+extern "C"
 {
-    kc_gg *gg = kc_gg_start(nvars, outs);
-    int i, top;
-    for (i = 0; i < outs->size; i++)
+    // running the synthesis server reading the requests from stdin (or from the socket, if the path is given)
+    int kc_top_level_server(char *pSocket, int verbose)
     {
-        kc_vt_resize(&gg->funcs, 0);
-        kc_vt_move(&gg->funcs, &gg->outs, i);
-        if (and_only)
-            top = synthesis_and_rec(gg, 0, nvars - 1);
-        else
-            top = synthesis_xor_rec(gg, 0, nvars - 1);
-        kc_vi_push(&gg->tops, top);
+        kc_server Server, *p = &Server;
+        p->gg = NULL;
+        p->nreqs = p->nhits = 0;
+        p->verbose = verbose;
+        kc_vt_start(&p->outs, 1, 1);
+        int Res = pSocket ? kc_server_socket(p, pSocket) : kc_server_serve(p, stdin, stdout);
+        fprintf(stderr, "Served %d requests (%d from the cache).\n", p->nreqs, p->nhits);
+        kc_gg_stop(p->gg);
+        kc_vt_stop(&p->outs);
+        return Res;
     }
-    return gg;
 }
 
-// solve the problem for all variable orders
-static inline void kc_top_level_call_perm(int nvars, kc_vt *outs, int and_only, int verbose)
+/*************************************************************
+              Batch synthesis of small functions
+**************************************************************/
+
+#define KC_BATCH_MAX_VARS 6 // the largest number of inputs of the functions in the batch (one word each)
+
+// the state kept between the batches: the graph, the truth table, and the cache of results
+typedef struct kc_batch_
 {
-    kc_vt Best, *best = &Best;
-    kc_vt_start(best, outs->size, outs->words);
-    // initialize permutation
-    int i, k, currPerm[MAX_VARS] = {0};
-    for (i = 0; i < nvars; i++)
-        currPerm[i] = i;
-    // go through permutations and find the best one
-    int CostBest = 0x7FFFFFFF;
-    int fact = kc_factorial(nvars);
-    for (i = 0; i < fact; i++)
+    kc_gg *gg;                                             // the graph reused by all functions
+    kc_vt outs;                                            // the truth table of the current function
+    kc_par par;                                            // the parameters of synthesis
+    std::unordered_map<kc_uint64, std::vector<int>> cache; // the netlists of the semi-canonical forms
+    long long nfuncs;                                      // the number of functions
+    long long nhits;                                       // the number of functions served from the cache
+} kc_batch;
+
+// computes the semi-canonical form of the function (stretched to one word): the output and each input are
+// complemented to have at most half of the minterms in the function and in the positive cofactor, and the inputs
+// are sorted by the number of minterms in their positive cofactors; NPN-equivalent functions mostly get the same
+// form (but not always, because of the ties); the function is the form complemented by *pOut whose input k
+// is fed by the literal pLits[k] (the variable times 2 plus the complement)
+static inline kc_uint64 kc_npn_semi_canon(kc_uint64 t, int nVars, int *pLits, int *pOut)
+{
+    int k, n, Ones[KC_BATCH_MAX_VARS], fChange = 1;
+    *pOut = 0;
+    if (kc_word_count_ones(t) > 32)
+        t = ~t, *pOut = 1;
+    for (k = 0; k < nVars; k++)
     {
-        kc_gg *ggTemp = kc_top_level_call_one(nvars, outs, and_only, verbose);
-        int CostThis = kc_gg_node_count(ggTemp);
-        if (CostBest > CostThis)
-        {
-            CostBest = CostThis;
-            kc_vt_stop(best);
-            kc_vt_dup(best, outs);
-        }
-        kc_gg_stop(ggTemp);
-        if (verbose)
+        pLits[k] = 2 * k;
+        Ones[k] = kc_word_count_ones(t & s_Truths6[k]);
+        if (Ones[k] > kc_word_count_ones(t & s_Truths6Neg[k]))
         {
-            printf("%3d :", i);
-            for (k = 0; k < nvars; k++)
-                printf(" %d", currPerm[k]);
-            printf(" : cost = %3d", CostThis);
-            printf("\n");
+            t = ((t & s_Truths6[k]) >> (1 << k)) | ((t & s_Truths6Neg[k]) << (1 << k));
+            Ones[k] = kc_word_count_ones(t & s_Truths6[k]);
+            pLits[k] ^= 1;
         }
-        kc_get_next_perm(currPerm, nvars, outs);
     }
-    // update the truth table according to the best permutation
-    kc_vt_stop(outs);
-    kc_vt_dup(outs, best);
-    kc_vt_stop(best);
+    for (n = nVars - 1; fChange; n--) // bubble sort by adjacent swaps
+        for (fChange = 0, k = 0; k < n; k++)
+            if (Ones[k] > Ones[k + 1])
+            {
+                kc_uint64 *s_PMasks = s_PPMasks[k][k + 1];
+                t = (t & s_PMasks[0]) | ((t & s_PMasks[1]) << (1 << k)) | ((t & s_PMasks[2]) >> (1 << k));
+                KC_SWAP(int, Ones[k], Ones[k + 1])
+                KC_SWAP(int, pLits[k], pLits[k + 1])
+                fChange = 1;
+            }
+    return t;
 }
 
-// dump the result of solving the problem into a file (for example, "stats.txt")
-static inline void kc_top_level_stats(char *pInput, int nvars, int nouts, int Cost)
+// computes the canonical form of the function of 4 inputs (stretched to one word) using the table of NPN classes
+// (the results have the same meaning as above, and the NPN-equivalent functions always get the same form)
+static inline kc_uint64 kc_npn4_canon(kc_uint64 t, int *pLits, int *pOut)
 {
-    char *pDumpFile = (char *)"stats.txt";
-    FILE *pFile = fopen(pDumpFile, "a+");
-    if (pFile == NULL)
+    unsigned Entry = kc_npn4_table()[t & 0xFFFF];
+    for (int k = 0; k < 4; k++)
+        pLits[k] = 2 * ((Entry >> 3 * k) & 3) + ((Entry >> (3 * k + 2)) & 1);
+    *pOut = (Entry >> 12) & 1;
+    return kc_truth_stretch(Entry >> 16, 4);
+}
+
+// the netlist of the graph with one output: the number of nodes, the output literal, and the fanins of the nodes
+static inline void kc_batch_netlist(kc_gg *gg, std::vector<int> &Net)
+{
+    Net.assign(1, gg->size - 1 - gg->nins);
+    Net.push_back(kc_vi_read(&gg->tops, 0));
+    Net.insert(Net.end(), kc_vi_array(&gg->fans) + 2 * (1 + gg->nins), kc_vi_array(&gg->fans) + 2 * gg->size);
+}
+// synthesizes the function and returns its netlist (the inputs are in the original order if the orders are tried)
+static inline std::vector<int> &kc_batch_solve(kc_batch *p, kc_uint64 t, int nVars)
+{
+    std::vector<int> &Net = p->cache[t];
+    kc_vt_restart(&p->outs, 1, 1);
+    *kc_vt_append(&p->outs) = t;
+    int Perm[MAX_VARS];
+    unsigned Phase = 0;
+    if (p->par.try_perm)
+        kc_top_level_call_perm(nVars, &p->outs, &p->par, Perm, &Phase);
+    if (p->gg == NULL)
+        p->gg = kc_gg_start(nVars, &p->outs);
+    else
+        kc_gg_restart(p->gg, nVars, &p->outs);
+    kc_top_level_synth(p->gg, &p->par);
+    if (!p->par.try_perm)
     {
-        printf("Cannot open file \"%s\" for reading.\n", pDumpFile);
-        return;
+        kc_batch_netlist(p->gg, Net);
+        return Net;
     }
-    fprintf(pFile, "%s %d %d %d\n", pInput, nvars, nouts, Cost);
-    fclose(pFile);
-    printf("Added statistics for \"%s\" to the file \"%s\".\n", pInput, pDumpFile);
+    memcpy(p->gg->perm, Perm, sizeof(int) * nVars), p->gg->phase = Phase;
+    kc_gg_node_count(p->gg);
+    kc_gg *ggNew = kc_gg_dup(p->gg, 0);
+    kc_batch_netlist(ggNew, Net);
+    kc_gg_stop(ggNew);
+    return Net;
+}
+// appends the netlist with the inputs replaced by the given literals and the output complemented if needed
+static inline int *kc_batch_transform(std::vector<int> &Net, int nVars, int *pLits, int fOut, int *pBuffer)
+{
+    int k, Map[2 * (1 + KC_BATCH_MAX_VARS)];
+    Map[0] = 0, Map[1] = 1;
+    for (k = 0; k < nVars; k++)
+        Map[2 * (1 + k)] = 2 + pLits[k], Map[2 * (1 + k) + 1] = kc_lnot(2 + pLits[k]);
+    *pBuffer++ = Net[0];
+    for (k = 1; k < (int)Net.size(); k++)
+        *pBuffer++ = Net[k] < 2 * (1 + nVars) ? Map[Net[k]] : Net[k];
+    pBuffer[-2 * Net[0] - 1] ^= fOut;
+    for (k = 0; k < Net[0]; k++) // keep the order of fanins marking xor-gates
+    {
+        int *pFans = pBuffer - 2 * Net[0] + 2 * k, fXor = Net[2 + 2 * k] > Net[3 + 2 * k];
+        if ((pFans[0] > pFans[1]) != fXor)
+            KC_SWAP(int, pFans[0], pFans[1])
+    }
+    return pBuffer;
+}
+// computes the function of the netlist (as a stretched truth table)
+static inline kc_uint64 kc_batch_eval(const int *pNet, int nVars)
+{
+    kc_uint64 Sims[2 * (1 + KC_BATCH_MAX_VARS + 256)];
+    int k, nNodes = pNet[0];
+    if (nNodes > 256)
+        return 0; // not expected for the functions of 6 inputs
+    Sims[0] = 0, Sims[1] = ~(kc_uint64)0;
+    for (k = 0; k < nVars; k++)
+        Sims[2 * (1 + k)] = s_Truths6[k], Sims[2 * (1 + k) + 1] = ~s_Truths6[k];
+    for (k = 0; k < nNodes; k++)
+    {
+        int i = 1 + nVars + k, f0 = pNet[2 + 2 * k], f1 = pNet[3 + 2 * k];
+        Sims[2 * i] = f0 > f1 ? Sims[f0] ^ Sims[f1] : Sims[f0] & Sims[f1];
+        Sims[2 * i + 1] = ~Sims[2 * i];
+    }
+    return Sims[pNet[1]];
 }
 
 extern "C"
 {
+    // starts the batch synthesis with the given parameters (the cache of results is kept until the end)
+    kc_batch *kc_batch_start(kc_par *par)
+    {
+        kc_batch *p = new kc_batch;
+        p->gg = NULL;
+        kc_vt_start(&p->outs, 1, 1);
+        p->par = *par;
+        p->par.verbose = 0;
+        p->nfuncs = p->nhits = 0;
+        return p;
+    }
+    void kc_batch_stop(kc_batch *p)
+    {
+        kc_gg_stop(p->gg);
+        kc_vt_stop(&p->outs);
+        delete p;
+    }
 
-    // solving one instance of a problem
-    int kc_top_level_call(char *input, int try_perm, int and_only, int verbose)
+    // synthesizes the functions of nVars <= 6 inputs given by their truth tables (one word each) and writes their
+    // netlists one after another into the buffer: the number of nodes, the output literal, and the two fanins of each
+    // node (literal 2*(1+i) is input i, literal 2*(1+nVars+k) is node k, which is an xor-gate if its first fanin is larger);
+    // stops before the first netlist that does not fit; returns the number of functions done and sets *pnInts
+    // to the number of integers written; the functions of the same semi-canonical form (the same NPN class
+    // for 4 inputs) are synthesized once
+    int kc_batch_synth(kc_batch *p, const kc_uint64 *pTruths, int nFuncs, int nVars, int *pBuffer, long long nInts, long long *pnInts)
     {
-        clock_t clkStart = clock();
-        kc_vt Outs, *outs = &Outs;
-        int nvars = kc_read_input_data(input, outs);
-        if (nvars == 0)
-            return 0;
-        assert(nvars <= MAX_VARS);
-        if (try_perm)
-            kc_top_level_call_perm(nvars, outs, and_only, verbose);
-        kc_gg *gg = kc_top_level_call_one(nvars, outs, and_only, verbose);
-        kc_gg_print(gg, verbose);
-        kc_gg_verify(gg);
-        printf("Time =%6.2f sec\n", (float)(clock() - clkStart) / CLOCKS_PER_SEC);
-        std::string str(input);
-        size_t found = (str.find_last_of("/"));
-        str = (str.substr(found+1, 4));
-        
-        str = str + ".aig";
-        kc_gg_aiger_write((char *)str.c_str(), gg, 1);
-        kc_top_level_stats((char *)str.c_str(), nvars, outs->size, kc_gg_node_count(gg));
-        kc_gg_stop(gg);
-        kc_vt_stop(outs);
-        return 1;
+        int i, Lits[KC_BATCH_MAX_VARS], fOut;
+        int *pStart = pBuffer, *pLimit = pBuffer + nInts;
+        assert(nVars >= 1 && nVars <= KC_BATCH_MAX_VARS);
+        kc_uint64 Mask = nVars == 6 ? ~(kc_uint64)0 : ((kc_uint64)1 << (1 << nVars)) - 1;
+        for (i = 0; i < nFuncs; i++)
+        {
+            kc_uint64 t = kc_truth_stretch(pTruths[i] & Mask, nVars);
+            t = nVars == 4 ? kc_npn4_canon(t, Lits, &fOut) : kc_npn_semi_canon(t, nVars, Lits, &fOut);
+            std::unordered_map<kc_uint64, std::vector<int>>::iterator it = p->cache.find(t);
+            std::vector<int> &Net = it != p->cache.end() ? it->second : kc_batch_solve(p, t, nVars);
+            if (pLimit - pBuffer < (long long)Net.size())
+                break;
+            p->nhits += it != p->cache.end();
+            pBuffer = kc_batch_transform(Net, nVars, Lits, fOut, pBuffer);
+        }
+        p->nfuncs += i;
+        *pnInts = pBuffer - pStart;
+        return i;
     }
 
-    // solving all problems in the list
-    int kc_top_level_list(char *pInput, int try_perm, int and_only, int verbose)
+    // synthesizes each output of the input as a separate function, verifies the netlists by simulation,
+    // and writes them into the binary file of 32-bit integers (for example, "inputs/ex00.truth" into "outputs/ex00.nets")
+    int kc_top_level_batch(char *input, kc_par *par)
     {
-        FILE *pFile = fopen(pInput, "rb");
-        if (pFile == NULL)
+        double timeStart = kc_wall_time();
+        kc_vt Outs, *outs = &Outs;
+        int i, nvars = kc_read_input_data(input, outs), nFailed = 0;
+        if (nvars == 0)
+            return 0;
+        if (nvars > KC_BATCH_MAX_VARS)
         {
-            printf("Cannot open file \"%s\" for reading.\n", pInput);
+            printf("The batch mode expects functions with at most %d inputs (the input has %d).\n", KC_BATCH_MAX_VARS, nvars);
+            kc_vt_stop(outs);
             return 0;
         }
-        char Buffer[1000];
-        int nProbs = 0;
-        while (fscanf(pFile, "%s", Buffer) == 1)
+        int nFuncs = outs->size;
+        std::vector<kc_uint64> Truths(nFuncs);
+        for (i = 0; i < nFuncs; i++)
+            Truths[i] = kc_vt_read(outs, i)[0];
+        kc_vt_stop(outs);
+        // every netlist fits into the buffer sized for the largest one
+        std::vector<int> Buffer((size_t)nFuncs * (2 + 2 * 256));
+        long long nInts = 0;
+        kc_batch *p = kc_batch_start(par);
+        double timeSynth = kc_wall_time();
+        int nDone = kc_batch_synth(p, Truths.data(), nFuncs, nvars, Buffer.data(), (long long)Buffer.size(), &nInts);
+        timeSynth = kc_wall_time() - timeSynth;
+        const int *pNet = Buffer.data();
+        long long nNodes = 0;
+        for (i = 0; i < nDone; pNet += 2 + 2 * pNet[0], i++)
         {
-            printf("\nSolving problem \"%s\".\n", Buffer);
-            kc_top_level_call(Buffer, try_perm, and_only, verbose), nProbs++;
+            nNodes += pNet[0];
+            kc_uint64 Mask = nvars == 6 ? ~(kc_uint64)0 : ((kc_uint64)1 << (1 << nvars)) - 1;
+            nFailed += (kc_batch_eval(pNet, nvars) & Mask) != (Truths[i] & Mask);
+        }
+        printf("Synthesized %d functions (%lld from the cache of %d semi-canonical forms) with %lld nodes.  ",
+               nDone, p->nhits, (int)p->cache.size(), nNodes);
+        printf("%.2f functions per microsecond.\n", timeSynth > 0 ? nDone / (1e6 * timeSynth) : 0.0);
+        kc_batch_stop(p);
+        if (nFailed)
+            printf("Verification failed for %d functions.  ", nFailed);
+        else
+            printf("Verification succeeded.  ");
+        printf("Time =%6.2f sec\n", kc_wall_time() - timeStart);
+        std::string str = kc_output_file_name(input, ".nets");
+        FILE *pFile = fopen(str.c_str(), "wb");
+        if (pFile == NULL)
+        {
+            printf("Cannot open file \"%s\" for writing.\n", str.c_str());
+            return 0;
         }
+        fwrite(Buffer.data(), sizeof(int), (size_t)nInts, pFile);
         fclose(pFile);
-        printf("\nFinished solving %d problems from the list \"%s\".\n", nProbs, pInput);
-        return 1;
+        printf("Written %d netlists into file \"%s\".\n", nDone, str.c_str());
+        return nFailed == 0;
     }
 }
 
@@ -1287,33 +5224,176 @@ int main(int argc, char **argv)
 {
     if (argc == 1)
     {
-        printf("usage:  %s [-p] [-a] [-v] <string>\n", argv[0]);
+        printf("usage:  %s [-p] [-a] [-n] [-K <num>] [-e] [-d] [-D <num>] [--fprm] [-l] [-r] [-f <fmt>] [--verify <mode>] [-j <num>] [-c] [-i <num>] [--time-limit <sec>] [--mem-limit <MB>] [--shard <i/N>] [--merge <N>] [--resume] [--chunk <num>] [--portfolio] [--profile] [-v] <string>\n", argv[0]);
+        printf("        %s -s [-S <path>] [-v]\n", argv[0]);
+        printf("        %s --batch [-p] [-a] [-l] <file>\n", argv[0]);
+        printf("        %s --bench\n", argv[0]);
         printf("        this program synthesized circuits from truth tables\n");
         printf("        -p : enables trying all variable permutations\n");
         printf("        -a : enables using only and-gates (no xor-gates)\n");
+        printf("        -n : enables complementing skew-symmetric inputs to reduce the number of orders\n");
+        printf("        -K : synthesizes only the given number of orders with the smallest estimated cost\n");
+        printf("        -e : synthesizes only the order with the smallest estimated cost found by dynamic programming\n");
+        printf("             (the estimate is the size of the shared BDD, so other orders may give smaller circuits)\n");
+        printf("        -d : enables minimizing the number of levels before the number of nodes\n");
+        printf("        -D : minimizes the number of nodes under the given number of levels\n");
+        printf("        --fprm : tries the fixed-polarity Reed-Muller form with the fewest terms and keeps it if it is smaller\n");
+        printf("        -l : enables building the functions of the bottom %d variables from the library of structures\n", KC_LIB_VARS);
+        printf("        -r : enables rewriting the resulting AIG using 4-input cuts\n");
+        printf("        -f : selects the output format: aig (default), blif or v (netlists with xor-gates)\n");
+        printf("        --verify : selects the verification: tt (stored truth tables, default), sim (simulation),\n");
+        printf("             or rand (simulation of %d random words of the truth tables)\n", KC_SIM_RANDOM);
+        printf("        -j : sets the number of threads used by the verification by simulation\n");
+        printf("        -c : converts the input into binary truth-table file (.ttb) without synthesis\n");
+        printf("             (a .filelist is converted into an archive of problems (.kca))\n");
+        printf("        -i : selects one problem of the archive by its index\n");
+        printf("        --time-limit : stops trying variable orders after the given number of seconds\n");
+        printf("                       (the orders are tried by the estimated cost if there are at most %d of them,\n", KC_ANYTIME_RANK_MAX);
+        printf("                       otherwise two orders by the influence of the inputs are tried first)\n");
+        printf("        --mem-limit  : stops trying variable orders when the memory exceeds the given number of MB\n");
+        printf("             (with a limit, promising orders are tried first and the best one found is used)\n");
+        printf("        --shard : tries only slice i of N equal slices of the variable orders and records its best order\n");
+        printf("        --merge : synthesizes the best order recorded by the given number of slices\n");
+        printf("        --resume : continues the search over variable orders from the state saved by the previous run\n");
+        printf("             (the state of the search is saved every %.0f seconds and when the time or memory limit stops it)\n", KC_CHECKPOINT_PERIOD);
+        printf("        --chunk : reads and synthesizes the given number of outputs at a time into one graph\n");
+        printf("             (the truth tables of the other outputs are not kept in memory)\n");
+        printf("        --portfolio : runs several strategies (and-only, xor, estimated orders, all orders) in parallel\n");
+        printf("             until the time limit (%.0f sec by default) and keeps the result with the fewest and-nodes\n", KC_PORTFOLIO_TIME);
+        printf("        -s : runs the server reading requests \"[-p] [-a] <hex> [<hex> ...]\" from stdin\n");
+        printf("        -S : runs the server on the Unix domain socket with the given path\n");
+        printf("        --batch : synthesizes each output (with at most %d inputs) as a separate function,\n", KC_BATCH_MAX_VARS);
+        printf("             reusing the results for the functions of the same semi-canonical NPN form\n");
         printf("        -v : enables verbose output\n");
+        printf("        --bench : checks and measures the operations on truth tables with 6-16 variables\n");
+        printf("        --profile      : prints the profiling counters after the run (if compiled with -DKC_PROFILE)\n");
+        printf("        --profile-json : prints the profiling counters in JSON\n");
         printf("  <string> : a truth table in hex notation or a file name\n");
+        printf("             (.truth, .pla, .blif, .aig/.aag, .ttb, .filelist, or .kca)\n");
         return 1;
     }
     else
     {
-        int try_perm = 0;
-        int and_only = 0;
-        int verbose = 0;
-        int i;
+        kc_par Par, *par = &Par;
+        kc_par_default(par);
+        int convert = 0;
+        int prob_id = -1;
+        int server = 0;
+        int batch = 0;
+        int bench = 0;
+        char *pSocket = NULL;
+        int profile = 0;
+        int i, Res;
         for (i = 1; i < argc; i++)
         {
             if (argv[i][0] == '-' && argv[i][1] == 'p' && argv[i][2] == '\0')
-                try_perm ^= 1;
+                par->try_perm ^= 1;
             if (argv[i][0] == '-' && argv[i][1] == 'a' && argv[i][2] == '\0')
-                and_only ^= 1;
+                par->and_only ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 'n' && argv[i][2] == '\0')
+                par->phase ^= 1;
             if (argv[i][0] == '-' && argv[i][1] == 'v' && argv[i][2] == '\0')
-                verbose ^= 1;
+                par->verbose ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 'c' && argv[i][2] == '\0')
+                convert ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 'i' && argv[i][2] == '\0' && i + 2 < argc)
+                prob_id = atoi(argv[++i]);
+            if (argv[i][0] == '-' && argv[i][1] == 'f' && argv[i][2] == '\0' && i + 2 < argc)
+                par->format = argv[++i];
+            if (argv[i][0] == '-' && argv[i][1] == 'r' && argv[i][2] == '\0')
+                par->rewrite ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 'j' && argv[i][2] == '\0' && i + 2 < argc)
+                par->threads = atoi(argv[++i]);
+            if (!strcmp(argv[i], "--verify") && i + 2 < argc)
+            {
+                i++;
+                par->verify = !strcmp(argv[i], "sim") ? 1 : !strcmp(argv[i], "rand") ? 2 : !strcmp(argv[i], "tt") ? 0 : -1;
+            }
+            if (argv[i][0] == '-' && argv[i][1] == 'd' && argv[i][2] == '\0')
+                par->delay ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 'D' && argv[i][2] == '\0' && i + 2 < argc)
+                par->delay = 1, par->max_level = atoi(argv[++i]);
+            if (argv[i][0] == '-' && argv[i][1] == 'e' && argv[i][2] == '\0')
+                par->est_best ^= 1;
+            if (!strcmp(argv[i], "--fprm"))
+                par->fprm ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 'l' && argv[i][2] == '\0')
+                par->lib ^= 1;
+            if (!strcmp(argv[i], "--shard") && i + 2 < argc)
+            {
+                if (sscanf(argv[++i], "%lld/%lld", &par->shard_id, &par->shard_num) != 2 || par->shard_id < 0 || par->shard_id >= par->shard_num)
+                {
+                    printf("The slice should be given as \"i/N\" with 0 <= i < N.\n");
+                    return 0;
+                }
+            }
+            if (!strcmp(argv[i], "--merge") && i + 2 < argc)
+                par->merge = atoi(argv[++i]);
+            if (!strcmp(argv[i], "--resume"))
+                par->resume ^= 1;
+            if (!strcmp(argv[i], "--chunk") && i + 2 < argc)
+                par->chunk = atoi(argv[++i]);
+            if (!strcmp(argv[i], "--portfolio"))
+                par->portfolio ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 'K' && argv[i][2] == '\0' && i + 2 < argc)
+                par->top_k = atoi(argv[++i]);
+            if (!strcmp(argv[i], "--time-limit") && i + 2 < argc)
+                par->time_limit = atof(argv[++i]);
+            if (!strcmp(argv[i], "--mem-limit") && i + 2 < argc)
+                par->mem_limit = atoi(argv[++i]);
+            if (!strcmp(argv[i], "--profile"))
+                profile = 1;
+            if (!strcmp(argv[i], "--profile-json"))
+                profile = 2;
+            if (!strcmp(argv[i], "--batch"))
+                batch ^= 1;
+            if (!strcmp(argv[i], "--bench"))
+                bench ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 's' && argv[i][2] == '\0')
+                server ^= 1;
+            if (argv[i][0] == '-' && argv[i][1] == 'S' && argv[i][2] == '\0' && i + 1 < argc)
+                server = 1, pSocket = argv[++i];
+        }
+        if (par->shard_num > 0 || par->merge > 0) // the slices are the slices of the variable orders
+            par->try_perm = 1;
+        if (par->verify < 0)
+        {
+            printf("Unknown verification mode (expecting tt, sim, or rand).\n");
+            return 0;
+        }
+        if (par->format && strcmp(par->format, "aig") && strcmp(par->format, "blif") && strcmp(par->format, "v"))
+        {
+            printf("Unknown output format \"%s\" (expecting aig, blif, or v).\n", par->format);
+            return 0;
+        }
+        if (par->format && strcmp(par->format, "aig") && (server || batch || kc_file_has_ext(argv[argc - 1], ".kca")))
+        {
+            printf("The output format cannot be selected for the server, the batches, and the archives.\n");
+            return 0;
         }
-        if (strstr(argv[argc - 1], ".filelist")) // solve several problems
-            return kc_top_level_list(argv[argc - 1], try_perm, and_only, verbose);
+        if (bench) // check and measure the operations on truth tables
+            Res = kc_vt_bench(6, MAX_VARS);
+        else if (server) // serve requests until the end of stdin or the "shutdown" request
+            Res = kc_top_level_server(pSocket, par->verbose);
+        else if (batch) // synthesize each output as a separate small function
+            Res = kc_top_level_batch(argv[argc - 1], par);
+        else if (convert && strstr(argv[argc - 1], ".filelist")) // collect several problems into an archive
+            Res = kc_top_level_convert_list(argv[argc - 1]);
+        else if (convert) // convert the input into the binary format
+            Res = kc_top_level_convert(argv[argc - 1]);
+        else if (par->portfolio) // solve one problem by several strategies in parallel
+            Res = kc_top_level_portfolio(argv[argc - 1], par);
+        else if (par->chunk > 0) // solve one problem reading the outputs in chunks
+            Res = kc_top_level_stream(argv[argc - 1], par);
+        else if (kc_file_has_ext(argv[argc - 1], ".kca")) // solve problems from an archive
+            Res = kc_top_level_archive(argv[argc - 1], prob_id, par);
+        else if (strstr(argv[argc - 1], ".filelist")) // solve several problems
+            Res = kc_top_level_list(argv[argc - 1], par);
         else // solve one problem
-            return kc_top_level_call(argv[argc - 1], try_perm, and_only, verbose);
+            Res = kc_top_level_call_par(argv[argc - 1], par);
+        if (profile)
+            kc_prof_print(profile == 2);
+        return Res;
     }
 }
 